@@ -0,0 +1,107 @@
+#ifndef __CPU_FEATURES_H__
+#define __CPU_FEATURES_H__
+
+/*
+ * Runtime detection of the instruction sets used by the vectorized kernels.
+ * Kernels are compiled for their instruction set with TARGET_AVX2 / TARGET_SSE41 (no global -mavx2 flag is needed)
+ * and are only called after the matching check returned true, so the binaries still run on older CPUs.
+ */
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#   define HAS_X86_SIMD 1
+#   include <immintrin.h>
+#   ifdef _MSC_VER
+#       include <intrin.h>
+#   else
+#       include <cpuid.h>
+#   endif
+#endif
+
+#include <cstring>
+#include <string>
+
+#if defined(HAS_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+#   define TARGET_AVX2 __attribute__((target("avx2")))
+#   define TARGET_SSE41 __attribute__((target("sse4.1")))
+#else
+#   define TARGET_AVX2
+#   define TARGET_SSE41
+#endif
+
+/**
+ * @brief Checks if the CPU running the program supports AVX2 instructions
+ */
+inline bool cpuSupportsAvx2()
+{
+#if defined(HAS_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("avx2");
+#elif defined(HAS_X86_SIMD) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuidex(info, 1, 0);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    __cpuidex(info, 7, 0);
+    return osxsave && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 6) == 6;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Checks if the CPU running the program supports SSE4.1 instructions
+ */
+inline bool cpuSupportsSse41()
+{
+#if defined(HAS_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("sse4.1");
+#elif defined(HAS_X86_SIMD) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Brand string of the CPU running the program (e.g. "Intel(R) Core(TM) i7-8700 CPU @ 3.20GHz"),
+ *        "unknown" when the CPU does not report one
+ */
+inline std::string cpuBrand()
+{
+    unsigned int regs[12] = {0};
+#if defined(HAS_X86_SIMD) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, (int)0x80000000);
+    if ((unsigned int)info[0] < 0x80000004) {
+        return "unknown";
+    }
+    for (int i = 0; i < 3; i++) {
+        __cpuid(info, (int)(0x80000002 + i));
+        std::memcpy(regs + 4 * i, info, sizeof(info));
+    }
+#elif defined(HAS_X86_SIMD)
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000004) {
+        return "unknown";
+    }
+    for (unsigned int i = 0; i < 3; i++) {
+        __get_cpuid(0x80000002 + i, regs + 4 * i, regs + 4 * i + 1, regs + 4 * i + 2, regs + 4 * i + 3);
+    }
+#else
+    return "unknown";
+#endif
+    char brand[sizeof(regs) + 1];
+    std::memcpy(brand, regs, sizeof(regs));
+    brand[sizeof(regs)] = '\0';
+    std::string result(brand);
+    const std::size_t first = result.find_first_not_of(' ');
+    if (first == std::string::npos) {
+        return "unknown";
+    }
+    return result.substr(first, result.find_last_not_of(' ') - first + 1);
+}
+
+#endif // __CPU_FEATURES_H__
@@ -0,0 +1,240 @@
+#ifndef __DARY_HEAP_H__
+#define __DARY_HEAP_H__
+
+#include "Profiler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <utility>
+#include <vector>
+
+/*
+ * Priority queues built on the heaps from the laboratories, usable with any element type and comparator.
+ *
+ * The comparator follows std::priority_queue: comp(a, b) is true when a has a lower priority than b,
+ * so std::less gives a max-heap and std::greater a min-heap. The optional counters follow the laboratory
+ * conventions: a move is one assignment, every call of the comparator is one comparison.
+ */
+namespace heaps
+{
+    namespace detail
+    {
+        /**
+         * @brief Allocator returning memory aligned to Align bytes (a cache line by default)
+         */
+        template <typename T, std::size_t Align = 64>
+        struct AlignedAllocator
+        {
+            typedef T value_type;
+
+            template <typename U>
+            struct rebind
+            {
+                typedef AlignedAllocator<U, Align> other;
+            };
+
+            AlignedAllocator() {}
+
+            template <typename U>
+            AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+            T* allocate(std::size_t n)
+            {
+                // the pointer returned by operator new is kept just before the aligned block
+                char* raw = static_cast<char*>(::operator new(n * sizeof(T) + Align + sizeof(void*)));
+                const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw + sizeof(void*));
+                char* aligned = reinterpret_cast<char*>((start + Align - 1) & ~(std::uintptr_t)(Align - 1));
+                reinterpret_cast<void**>(aligned)[-1] = raw;
+                return reinterpret_cast<T*>(aligned);
+            }
+
+            void deallocate(T* p, std::size_t)
+            {
+                ::operator delete(reinterpret_cast<void**>(p)[-1]);
+            }
+
+            template <typename U>
+            bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+
+            template <typename U>
+            bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
+        };
+    } // namespace detail
+
+    /**
+     * @brief Priority queue on a heap where every node has D children
+     *
+     * A wider node makes the tree log2(D) times shallower, so a pop walks fewer levels at the price of D - 1
+     * comparisons per level. The storage starts on a cache line and is shifted by D - 1 slots, so the D children
+     * of a node are always one aligned block: with D * sizeof(T) <= 64 one pop touches a single cache line per level.
+     *
+     * @tparam T element type, must be default constructible (the D - 1 slots before the root hold unused values)
+     * @tparam D number of children of a node, 2, 4 or 8 are the useful ones
+     * @tparam Compare strict weak ordering, the largest element according to it is on top
+     */
+    template <typename T, int D = 4, typename Compare = std::less<T>>
+    class DaryHeap
+    {
+        static_assert(D >= 2, "a heap node needs at least two children");
+
+    public:
+        explicit DaryHeap(const Compare& comp = Compare()) : comp(comp), storage(PAD), opAsg(nullptr), opCmp(nullptr) {}
+
+        /**
+         * @brief Builds the heap from a range in linear time
+         */
+        template <typename InputIt>
+        DaryHeap(InputIt first, InputIt last, const Compare& comp = Compare())
+            : comp(comp), storage(PAD), opAsg(nullptr), opCmp(nullptr)
+        {
+            build(first, last);
+        }
+
+        /**
+         * @brief Sets the optional operation counters (assignments and comparisons)
+         */
+        void setCounters(Operation* asg, Operation* cmp)
+        {
+            opAsg = asg;
+            opCmp = cmp;
+        }
+
+        bool empty() const { return storage.size() == PAD; }
+        std::size_t size() const { return storage.size() - PAD; }
+        void reserve(std::size_t n) { storage.reserve(n + PAD); }
+        void clear() { storage.resize(PAD); }
+
+        /**
+         * @brief The element with the highest priority
+         */
+        const T& top() const { return storage[PAD]; }
+
+        void push(const T& value)
+        {
+            storage.push_back(value);
+            sift_up(size() - 1);
+        }
+
+        void push(T&& value)
+        {
+            storage.push_back(std::move(value));
+            sift_up(size() - 1);
+        }
+
+        /**
+         * @brief Removes the element with the highest priority
+         */
+        void pop()
+        {
+            if (size() > 1) {
+                at(0) = std::move(storage.back());
+                if (opAsg) opAsg->count();
+            }
+            storage.pop_back();
+            if (size() > 1) {
+                sift_down(0);
+            }
+        }
+
+        /**
+         * @brief Replaces the element with the highest priority, one sift instead of the two of pop() and push()
+         */
+        void replace_top(const T& value)
+        {
+            at(0) = value;
+            if (opAsg) opAsg->count();
+            sift_down(0);
+        }
+
+        /**
+         * @brief Adds all the elements of a range and restores the heap bottom-up, O(n + size())
+         */
+        template <typename InputIt>
+        void build(InputIt first, InputIt last)
+        {
+            storage.insert(storage.end(), first, last);
+            const std::size_t n = size();
+            if (n < 2) {
+                return;
+            }
+            for (std::size_t i = (n - 2) / D + 1; i-- > 0;) {
+                sift_down(i);
+            }
+        }
+
+    private:
+        static const std::size_t PAD = D - 1;
+
+        T& at(std::size_t i) { return storage[i + PAD]; }
+
+        bool lower(const T& a, const T& b)
+        {
+            if (opCmp) opCmp->count();
+            return comp(a, b);
+        }
+
+        void sift_up(std::size_t i)
+        {
+            T value = std::move(at(i));
+            if (opAsg) opAsg->count();
+            while (i > 0) {
+                const std::size_t parent = (i - 1) / D;
+                if (!lower(at(parent), value)) {
+                    break;
+                }
+                at(i) = std::move(at(parent));
+                if (opAsg) opAsg->count();
+                i = parent;
+            }
+            at(i) = std::move(value);
+            if (opAsg) opAsg->count();
+        }
+
+        void sift_down(std::size_t i)
+        {
+            const std::size_t n = size();
+            T value = std::move(at(i));
+            if (opAsg) opAsg->count();
+            for (;;) {
+                const std::size_t first = D * i + 1;
+                if (first >= n) {
+                    break;
+                }
+                // the children are one aligned block, the loop over a full node has a constant trip count
+                std::size_t best = first;
+                if (first + D <= n) {
+                    for (int c = 1; c < D; c++) {
+                        if (lower(at(best), at(first + c))) {
+                            best = first + c;
+                        }
+                    }
+                } else {
+                    for (std::size_t c = first + 1; c < n; c++) {
+                        if (lower(at(best), at(c))) {
+                            best = c;
+                        }
+                    }
+                }
+                if (!lower(value, at(best))) {
+                    break;
+                }
+                at(i) = std::move(at(best));
+                if (opAsg) opAsg->count();
+                i = best;
+            }
+            at(i) = std::move(value);
+            if (opAsg) opAsg->count();
+        }
+
+        Compare comp;
+        // element i of the heap is at storage[i + D - 1], so the children D * i + 1 ... D * i + D start at a multiple of D
+        std::vector<T, detail::AlignedAllocator<T>> storage;
+        Operation* opAsg;
+        Operation* opCmp;
+    };
+
+} // namespace heaps
+
+#endif // __DARY_HEAP_H__
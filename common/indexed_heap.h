@@ -0,0 +1,211 @@
+#ifndef __INDEXED_HEAP_H__
+#define __INDEXED_HEAP_H__
+
+#include "Profiler.h"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace heaps
+{
+    /**
+     * @brief Min-priority queue of the ids 0 ... n - 1 with a key each, supporting decrease-key
+     *
+     * The heap is the one from lab02 with D children per node, holding (key, id) pairs so the comparisons never
+     * leave the heap array. A second array keeps the position of every id in the heap, updated on every move,
+     * which gives contains() and the start of decrease_key() in O(1). This is the queue needed by Dijkstra and Prim.
+     *
+     * @tparam Key priority type
+     * @tparam D number of children of a node
+     * @tparam Compare strict weak ordering, the smallest key according to it is on top
+     */
+    template <typename Key, int D = 4, typename Compare = std::less<Key>>
+    class IndexedHeap
+    {
+        static_assert(D >= 2, "a heap node needs at least two children");
+
+    public:
+        /**
+         * @brief Empty queue for the ids 0 ... n - 1
+         */
+        explicit IndexedHeap(int n, const Compare& comp = Compare())
+            : comp(comp), positions(n, -1), opAsg(nullptr), opCmp(nullptr)
+        {
+            heap.reserve(n);
+        }
+
+        /**
+         * @brief Sets the optional operation counters (assignments and comparisons)
+         */
+        void setCounters(Operation* asg, Operation* cmp)
+        {
+            opAsg = asg;
+            opCmp = cmp;
+        }
+
+        bool empty() const { return heap.empty(); }
+        int size() const { return (int)heap.size(); }
+
+        /**
+         * @brief Number of ids the queue was created for
+         */
+        int capacity() const { return (int)positions.size(); }
+
+        bool contains(int id) const { return positions[id] >= 0; }
+
+        /**
+         * @brief Index of the id in the heap array, -1 if it is not in the queue
+         */
+        int position(int id) const { return positions[id]; }
+
+        /**
+         * @brief Key of an id that is in the queue
+         */
+        const Key& key(int id) const { return heap[positions[id]].key; }
+
+        /**
+         * @brief Id with the smallest key
+         */
+        int top() const { return heap[0].id; }
+        const Key& top_key() const { return heap[0].key; }
+
+        /**
+         * @brief Adds an id that is not in the queue yet
+         */
+        void push(int id, const Key& key)
+        {
+            Entry entry = {key, id};
+            heap.push_back(entry);
+            positions[id] = size() - 1;
+            sift_up(size() - 1);
+        }
+
+        /**
+         * @brief Removes the id with the smallest key and returns it
+         */
+        int pop_min()
+        {
+            const int id = heap[0].id;
+            positions[id] = -1;
+            if (size() > 1) {
+                heap[0] = std::move(heap.back());
+                positions[heap[0].id] = 0;
+                if (opAsg) opAsg->count();
+                heap.pop_back();
+                sift_down(0);
+            } else {
+                heap.pop_back();
+            }
+            return id;
+        }
+
+        /**
+         * @brief Lowers the key of an id in the queue, the new key must not be greater than the old one
+         */
+        void decrease_key(int id, const Key& key)
+        {
+            const int i = positions[id];
+            heap[i].key = key;
+            if (opAsg) opAsg->count();
+            sift_up(i);
+        }
+
+        /**
+         * @brief Pushes the id, or lowers its key if the new one is smaller (the relaxation step of Dijkstra and Prim)
+         *
+         * @return true if the id was added or its key changed
+         */
+        bool push_or_decrease(int id, const Key& key)
+        {
+            if (!contains(id)) {
+                push(id, key);
+                return true;
+            }
+            if (less(key, heap[positions[id]].key)) {
+                decrease_key(id, key);
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Removes every id
+         */
+        void clear()
+        {
+            for (const Entry& entry : heap) {
+                positions[entry.id] = -1;
+            }
+            heap.clear();
+        }
+
+    private:
+        struct Entry {
+            Key key;
+            int id;
+        };
+
+        bool less(const Key& a, const Key& b)
+        {
+            if (opCmp) opCmp->count();
+            return comp(a, b);
+        }
+
+        // writes the entry at heap position i and records the new position of its id
+        void place(int i, Entry&& entry)
+        {
+            positions[entry.id] = i;
+            heap[i] = std::move(entry);
+            if (opAsg) opAsg->count();
+        }
+
+        void sift_up(int i)
+        {
+            Entry entry = std::move(heap[i]);
+            while (i > 0) {
+                const int parent = (i - 1) / D;
+                if (!less(entry.key, heap[parent].key)) {
+                    break;
+                }
+                place(i, std::move(heap[parent]));
+                i = parent;
+            }
+            place(i, std::move(entry));
+        }
+
+        void sift_down(int i)
+        {
+            const int n = size();
+            Entry entry = std::move(heap[i]);
+            for (;;) {
+                const int first = D * i + 1;
+                if (first >= n) {
+                    break;
+                }
+                const int last = first + D < n ? first + D : n;
+                int best = first;
+                for (int c = first + 1; c < last; c++) {
+                    if (less(heap[c].key, heap[best].key)) {
+                        best = c;
+                    }
+                }
+                if (!less(heap[best].key, entry.key)) {
+                    break;
+                }
+                place(i, std::move(heap[best]));
+                i = best;
+            }
+            place(i, std::move(entry));
+        }
+
+        Compare comp;
+        std::vector<Entry> heap;
+        std::vector<int> positions; // position of every id in heap, -1 when it is not in the queue
+        Operation* opAsg;
+        Operation* opCmp;
+    };
+
+} // namespace heaps
+
+#endif // __INDEXED_HEAP_H__
@@ -0,0 +1,269 @@
+#ifndef __MINMAX_HEAP_H__
+#define __MINMAX_HEAP_H__
+
+#include "Profiler.h"
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace heaps
+{
+    /**
+     * @brief Double-ended priority queue: min-max heap of Atkinson et al.
+     *
+     * A binary heap whose levels alternate: the nodes on even levels (the root included) are not greater than any
+     * of their descendants, the nodes on odd levels are not smaller. The minimum is the root and the maximum is one
+     * of its two children, so both ends are read in O(1) and popped in O(log n), with every element stored once.
+     * A sift compares a node with its children and grandchildren and moves it two levels at a time.
+     *
+     * With a capacity the heap keeps only the capacity smallest elements it was given: a push into a full heap
+     * replaces the maximum, or is dropped when it is not smaller than the maximum.
+     *
+     * @tparam T element type
+     * @tparam Compare strict weak ordering
+     */
+    template <typename T, typename Compare = std::less<T>>
+    class MinMaxHeap
+    {
+    public:
+        /**
+         * @brief Empty heap, bounded to capacity elements if capacity is not 0
+         */
+        explicit MinMaxHeap(std::size_t capacity = 0, const Compare& comp = Compare())
+            : comp(comp), bound(capacity), opAsg(nullptr), opCmp(nullptr)
+        {
+            if (bound) {
+                heap.reserve(bound);
+            }
+        }
+
+        /**
+         * @brief Heap of the elements in [first, last), built in O(n)
+         */
+        template <typename InputIt>
+        MinMaxHeap(InputIt first, InputIt last, const Compare& comp = Compare())
+            : comp(comp), bound(0), opAsg(nullptr), opCmp(nullptr)
+        {
+            build(first, last);
+        }
+
+        /**
+         * @brief Sets the optional operation counters (assignments and comparisons)
+         */
+        void setCounters(Operation* asg, Operation* cmp)
+        {
+            opAsg = asg;
+            opCmp = cmp;
+        }
+
+        bool empty() const { return heap.empty(); }
+        std::size_t size() const { return heap.size(); }
+
+        /**
+         * @brief Largest number of elements kept, 0 if the heap is not bounded
+         */
+        std::size_t capacity() const { return bound; }
+        void reserve(std::size_t n) { heap.reserve(n); }
+        void clear() { heap.clear(); }
+
+        const T& min() const { return heap[0]; }
+        const T& max() const { return heap[maxIndex()]; }
+
+        /**
+         * @brief Adds a value, in a full bounded heap only if it is smaller than the maximum
+         *
+         * @return false if the value was dropped
+         */
+        bool push(const T& value)
+        {
+            if (bound && heap.size() >= bound) {
+                const std::size_t m = maxIndex();
+                if (!less(value, heap[m])) {
+                    return false;
+                }
+                // the new value takes the place of the maximum
+                heap[m] = value;
+                if (opAsg) opAsg->count();
+                if (m > 0 && less(heap[m], heap[0])) {
+                    swapAt(m, 0);
+                }
+                trickle_down(m);
+                return true;
+            }
+            heap.push_back(value);
+            if (opAsg) opAsg->count();
+            bubble_up(heap.size() - 1);
+            return true;
+        }
+
+        void pop_min()
+        {
+            removeAt(0);
+        }
+
+        void pop_max()
+        {
+            removeAt(maxIndex());
+        }
+
+        /**
+         * @brief Replaces the content with the elements in [first, last) (the bound is not applied), in O(n)
+         */
+        template <typename InputIt>
+        void build(InputIt first, InputIt last)
+        {
+            heap.assign(first, last);
+            for (std::size_t i = heap.size() / 2; i-- > 0; ) {
+                trickle_down(i);
+            }
+        }
+
+    private:
+        static bool isMinLevel(std::size_t i)
+        {
+            // the level of i is the position of the highest bit of i + 1
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_clzll((unsigned long long)i + 1) % 2 == 1;
+#else
+            int level = 0;
+            for (std::size_t x = i + 1; x > 1; x >>= 1) {
+                level++;
+            }
+            return level % 2 == 0;
+#endif
+        }
+
+        bool less(const T& a, const T& b)
+        {
+            if (opCmp) opCmp->count();
+            return comp(a, b);
+        }
+
+        // the order of a level: on the max levels "better" means greater
+        template <bool Max>
+        bool better(const T& a, const T& b)
+        {
+            return Max ? less(b, a) : less(a, b);
+        }
+
+        std::size_t maxIndex() const
+        {
+            if (heap.size() <= 2) {
+                return heap.size() - 1;
+            }
+            return comp(heap[1], heap[2]) ? 2 : 1;
+        }
+
+        void swapAt(std::size_t a, std::size_t b)
+        {
+            std::swap(heap[a], heap[b]);
+            if (opAsg) opAsg->count(3);
+        }
+
+        void removeAt(std::size_t i)
+        {
+            if (i + 1 < heap.size()) {
+                heap[i] = std::move(heap.back());
+                if (opAsg) opAsg->count();
+                heap.pop_back();
+                trickle_down(i);
+            } else {
+                heap.pop_back();
+            }
+        }
+
+        void trickle_down(std::size_t i)
+        {
+            if (isMinLevel(i)) {
+                trickle_down<false>(i);
+            } else {
+                trickle_down<true>(i);
+            }
+        }
+
+        template <bool Max>
+        void trickle_down(std::size_t i)
+        {
+            const std::size_t n = heap.size();
+            for (;;) {
+                const std::size_t child = 2 * i + 1;
+                if (child >= n) {
+                    return;
+                }
+                // best of the (up to) two children and four grandchildren
+                std::size_t m = child;
+                if (child + 1 < n && better<Max>(heap[child + 1], heap[m])) {
+                    m = child + 1;
+                }
+                const std::size_t grandchild = 2 * child + 1;
+                const std::size_t end = grandchild + 4 < n ? grandchild + 4 : n;
+                for (std::size_t g = grandchild; g < end; g++) {
+                    if (better<Max>(heap[g], heap[m])) {
+                        m = g;
+                    }
+                }
+                if (!better<Max>(heap[m], heap[i])) {
+                    return;
+                }
+                swapAt(m, i);
+                if (m < grandchild) {
+                    return;
+                }
+                // the value from i went two levels down, it may not fit under its new parent of the other order
+                const std::size_t parent = (m - 1) / 2;
+                if (better<Max>(heap[parent], heap[m])) {
+                    swapAt(m, parent);
+                }
+                i = m;
+            }
+        }
+
+        void bubble_up(std::size_t i)
+        {
+            if (i == 0) {
+                return;
+            }
+            const std::size_t parent = (i - 1) / 2;
+            if (isMinLevel(i)) {
+                if (less(heap[parent], heap[i])) {
+                    swapAt(i, parent);
+                    bubble_up<true>(parent);
+                } else {
+                    bubble_up<false>(i);
+                }
+            } else {
+                if (less(heap[i], heap[parent])) {
+                    swapAt(i, parent);
+                    bubble_up<false>(parent);
+                } else {
+                    bubble_up<true>(i);
+                }
+            }
+        }
+
+        // climbs through the levels of the same order, two at a time
+        template <bool Max>
+        void bubble_up(std::size_t i)
+        {
+            while (i > 2) {
+                const std::size_t grandparent = ((i - 1) / 2 - 1) / 2;
+                if (!better<Max>(heap[i], heap[grandparent])) {
+                    return;
+                }
+                swapAt(i, grandparent);
+                i = grandparent;
+            }
+        }
+
+        Compare comp;
+        std::vector<T> heap;
+        std::size_t bound;
+        Operation* opAsg;
+        Operation* opCmp;
+    };
+
+} // namespace heaps
+
+#endif // __MINMAX_HEAP_H__
@@ -0,0 +1,263 @@
+#ifndef __PAIRING_HEAP_H__
+#define __PAIRING_HEAP_H__
+
+#include "Profiler.h"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace heaps
+{
+    /**
+     * @brief Node of a pairing heap: the children of a node are a list linked through sibling
+     */
+    template <typename T>
+    struct PairingNode {
+        T value;
+        PairingNode* child;
+        PairingNode* sibling;
+    };
+
+    /**
+     * @brief Allocator for the nodes of pairing heaps
+     *
+     * The nodes are carved out of chunks of CHUNK nodes and released nodes are kept in a free list, so a push costs
+     * no call to new once the pool has grown and the nodes of a heap stay close together in memory.
+     * Heaps that are melded must share the pool their nodes came from.
+     */
+    template <typename T>
+    class NodePool
+    {
+    public:
+        typedef PairingNode<T> Node;
+        static const int CHUNK = 1024;
+
+        NodePool() : freeList(nullptr), used(CHUNK) {}
+
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        Node* allocate(const T& value)
+        {
+            Node* node = take();
+            new (&node->value) T(value);
+            node->child = nullptr;
+            node->sibling = nullptr;
+            return node;
+        }
+
+        Node* allocate(T&& value)
+        {
+            Node* node = take();
+            new (&node->value) T(std::move(value));
+            node->child = nullptr;
+            node->sibling = nullptr;
+            return node;
+        }
+
+        void release(Node* node)
+        {
+            node->value.~T();
+            node->sibling = freeList;
+            freeList = node;
+        }
+
+    private:
+        typedef typename std::aligned_storage<sizeof(Node), alignof(Node)>::type Slot;
+
+        Node* take()
+        {
+            if (freeList) {
+                Node* node = freeList;
+                freeList = node->sibling;
+                return node;
+            }
+            if (used == CHUNK) {
+                chunks.emplace_back(new Slot[CHUNK]);
+                used = 0;
+            }
+            return reinterpret_cast<Node*>(&chunks.back()[used++]);
+        }
+
+        std::vector<std::unique_ptr<Slot[]>> chunks;
+        Node* freeList; // released nodes, linked through sibling
+        int used; // slots taken from the last chunk
+    };
+
+    /**
+     * @brief Min-priority queue with O(1) push and meld and O(log n) amortized pop
+     *
+     * The heap is a tree where every node is not greater than its children. Push and meld link two roots: the
+     * greater one becomes the first child of the smaller one. Pop removes the root and pairs its children left to
+     * right, then links the pairs right to left into the new root, the two pass scheme of Fredman et al.
+     *
+     * @tparam T element type
+     * @tparam Compare strict weak ordering, the smallest element according to it is on top
+     */
+    template <typename T, typename Compare = std::less<T>>
+    class PairingHeap
+    {
+    public:
+        typedef NodePool<T> Pool;
+        typedef PairingNode<T> Node;
+
+        /**
+         * @brief Empty heap allocating from the given pool, a new one if none is given
+         */
+        explicit PairingHeap(std::shared_ptr<Pool> pool = std::make_shared<Pool>(), const Compare& comp = Compare())
+            : nodes(std::move(pool)), comp(comp), root(nullptr), count(0), opAsg(nullptr), opCmp(nullptr) {}
+
+        PairingHeap(const PairingHeap&) = delete;
+        PairingHeap& operator=(const PairingHeap&) = delete;
+
+        PairingHeap(PairingHeap&& other)
+            : nodes(other.nodes), comp(other.comp), root(other.root), count(other.count),
+              opAsg(other.opAsg), opCmp(other.opCmp)
+        {
+            other.root = nullptr;
+            other.count = 0;
+        }
+
+        ~PairingHeap() { clear(); }
+
+        /**
+         * @brief Sets the optional operation counters (pointer writes and comparisons)
+         */
+        void setCounters(Operation* asg, Operation* cmp)
+        {
+            opAsg = asg;
+            opCmp = cmp;
+        }
+
+        /**
+         * @brief The pool of the nodes, to be given to the heaps that will be melded with this one
+         */
+        const std::shared_ptr<Pool>& pool() const { return nodes; }
+
+        bool empty() const { return root == nullptr; }
+        std::size_t size() const { return count; }
+
+        const T& top() const { return root->value; }
+
+        void push(const T& value)
+        {
+            root = link(root, nodes->allocate(value));
+            count++;
+        }
+
+        void push(T&& value)
+        {
+            root = link(root, nodes->allocate(std::move(value)));
+            count++;
+        }
+
+        /**
+         * @brief Removes the smallest element
+         */
+        void pop()
+        {
+            Node* old = root;
+            root = mergePairs(root->child);
+            nodes->release(old);
+            count--;
+        }
+
+        /**
+         * @brief Moves every element of other into this heap in O(1), other is left empty
+         *
+         * Both heaps must allocate from the same pool.
+         */
+        void meld(PairingHeap& other)
+        {
+            assert(nodes == other.nodes);
+            root = link(root, other.root);
+            count += other.count;
+            other.root = nullptr;
+            other.count = 0;
+        }
+
+        void clear()
+        {
+            // walks the tree as a list: the children of a released node are spliced in front of its siblings
+            Node* pending = root;
+            while (pending) {
+                Node* node = pending;
+                if (node->child) {
+                    Node* last = node->child;
+                    while (last->sibling) {
+                        last = last->sibling;
+                    }
+                    last->sibling = node->sibling;
+                    pending = node->child;
+                } else {
+                    pending = node->sibling;
+                }
+                nodes->release(node);
+            }
+            root = nullptr;
+            count = 0;
+        }
+
+    private:
+        // a and b are roots, returns the root of their union
+        Node* link(Node* a, Node* b)
+        {
+            if (!a) return b;
+            if (!b) return a;
+            if (opCmp) opCmp->count();
+            if (comp(b->value, a->value)) {
+                std::swap(a, b);
+            }
+            b->sibling = a->child;
+            a->child = b;
+            if (opAsg) opAsg->count(2);
+            return a;
+        }
+
+        Node* mergePairs(Node* first)
+        {
+            // first pass: link the siblings in pairs, the results are kept in a stack linked through sibling
+            Node* pairs = nullptr;
+            while (first) {
+                Node* a = first;
+                Node* b = a->sibling;
+                if (!b) {
+                    a->sibling = pairs;
+                    pairs = a;
+                    break;
+                }
+                first = b->sibling;
+                a->sibling = nullptr;
+                b->sibling = nullptr;
+                Node* linked = link(a, b);
+                linked->sibling = pairs;
+                pairs = linked;
+            }
+            // second pass: link them from the last pair to the first
+            Node* result = nullptr;
+            while (pairs) {
+                Node* next = pairs->sibling;
+                pairs->sibling = nullptr;
+                result = link(result, pairs);
+                pairs = next;
+            }
+            return result;
+        }
+
+        std::shared_ptr<Pool> nodes;
+        Compare comp;
+        Node* root;
+        std::size_t count;
+        Operation* opAsg;
+        Operation* opCmp;
+    };
+
+} // namespace heaps
+
+#endif // __PAIRING_HEAP_H__
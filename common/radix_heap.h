@@ -0,0 +1,170 @@
+#ifndef __RADIX_HEAP_H__
+#define __RADIX_HEAP_H__
+
+#include "Profiler.h"
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace heaps
+{
+    namespace detail
+    {
+        // number of bits needed to write x, 0 for x = 0
+        template <typename Key>
+        int bit_width(Key x)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            if (x == 0) {
+                return 0;
+            }
+            return sizeof(Key) <= sizeof(unsigned int)
+                ? (int)(sizeof(unsigned int) * CHAR_BIT) - __builtin_clz((unsigned int)x)
+                : (int)(sizeof(unsigned long long) * CHAR_BIT) - __builtin_clzll((unsigned long long)x);
+#else
+            int width = 0;
+            while (x) {
+                x >>= 1;
+                width++;
+            }
+            return width;
+#endif
+        }
+    } // namespace detail
+
+    /**
+     * @brief Monotone min-priority queue for unsigned integer keys
+     *
+     * Bucket 0 holds the keys equal to the last popped key, bucket i the keys whose highest bit that differs from
+     * it is bit i - 1. When bucket 0 is empty the first non-empty bucket is emptied into the lower ones around its
+     * smallest key. A key moves only to lower buckets, so it is moved at most once per bit: push is O(1) and pop is
+     * O(log C) amortized, where C is the largest key, whatever the number of elements.
+     * The keys pushed must never be smaller than the last popped key (true for Dijkstra and event simulation).
+     *
+     * @tparam Value data carried with every key
+     * @tparam Key unsigned integer key type
+     */
+    template <typename Value, typename Key = std::uint32_t>
+    class RadixHeap
+    {
+        static const int BUCKETS = (int)(sizeof(Key) * CHAR_BIT) + 1;
+
+    public:
+        RadixHeap() : count(0), last(0), opAsg(nullptr), opCmp(nullptr) {}
+
+        /**
+         * @brief Sets the optional operation counters (element moves and key comparisons)
+         */
+        void setCounters(Operation* asg, Operation* cmp)
+        {
+            opAsg = asg;
+            opCmp = cmp;
+        }
+
+        bool empty() const { return count == 0; }
+        std::size_t size() const { return count; }
+
+        /**
+         * @brief Last popped key, the lower bound for the keys that can still be pushed
+         */
+        Key last_key() const { return last; }
+
+        void push(Key key, const Value& value)
+        {
+            buckets[bucket(key)].push_back(std::make_pair(key, value));
+            if (opAsg) opAsg->count();
+            count++;
+        }
+
+        void push(Key key, Value&& value)
+        {
+            buckets[bucket(key)].push_back(std::make_pair(key, std::move(value)));
+            if (opAsg) opAsg->count();
+            count++;
+        }
+
+        /**
+         * @brief The smallest key
+         */
+        Key top_key() const
+        {
+            pull();
+            return buckets[0].back().first;
+        }
+
+        /**
+         * @brief The value of the smallest key
+         */
+        const Value& top() const
+        {
+            pull();
+            return buckets[0].back().second;
+        }
+
+        /**
+         * @brief Removes the smallest key
+         */
+        void pop()
+        {
+            pull();
+            buckets[0].pop_back();
+            count--;
+        }
+
+        void clear()
+        {
+            for (int i = 0; i < BUCKETS; i++) {
+                buckets[i].clear();
+            }
+            count = 0;
+            last = 0;
+        }
+
+    private:
+        int bucket(Key key) const
+        {
+            return detail::bit_width<Key>(key ^ last);
+        }
+
+        // makes sure bucket 0 is not empty
+        void pull() const
+        {
+            if (!buckets[0].empty()) {
+                return;
+            }
+            int i = 1;
+            while (buckets[i].empty()) {
+                i++;
+            }
+
+            std::vector<std::pair<Key, Value>>& source = buckets[i];
+            Key smallest = source[0].first;
+            for (std::size_t k = 1; k < source.size(); k++) {
+                if (opCmp) opCmp->count();
+                if (source[k].first < smallest) {
+                    smallest = source[k].first;
+                }
+            }
+            // every key of the bucket shares the bits above i - 1 with smallest and differs below,
+            // so they all land in buckets lower than i
+            last = smallest;
+            for (std::size_t k = 0; k < source.size(); k++) {
+                buckets[bucket(source[k].first)].push_back(std::move(source[k]));
+                if (opAsg) opAsg->count();
+            }
+            source.clear();
+        }
+
+        mutable std::vector<std::pair<Key, Value>> buckets[BUCKETS];
+        std::size_t count;
+        mutable Key last;
+        Operation* opAsg;
+        Operation* opCmp;
+    };
+
+} // namespace heaps
+
+#endif // __RADIX_HEAP_H__
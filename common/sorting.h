@@ -0,0 +1,473 @@
+#ifndef __SORTING_H__
+#define __SORTING_H__
+
+#include "Profiler.h"
+
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Generic versions of the sorting algorithms from the laboratories, usable on any random access range
+ * (arrays of ints, Edge, Entry, std::string, ...).
+ *
+ * Every algorithm takes a comparator (a strict weak ordering, ascending by default) and a projection
+ * that extracts the key to compare from an element (the element itself by default), e.g. sorting
+ * edges by weight: sorting::quick_sort(edges, edges + n, sorting::less(), [](const Edge& e) { return e.weight; });
+ *
+ * Elements are moved and never copied, so records that are expensive to copy (or that cannot be copied at all)
+ * are handled as well. The optional counters follow the laboratory conventions: a move or a key read into a
+ * temporary is one assignment, a swap is three, every call of the comparator is one comparison.
+ */
+namespace sorting
+{
+    /**
+     * @brief Default projection, returns the element itself
+     */
+    struct identity
+    {
+        template <typename T>
+        T&& operator()(T&& value) const { return std::forward<T>(value); }
+    };
+
+    /**
+     * @brief Default comparator, ascending order using operator<
+     */
+    struct less
+    {
+        template <typename A, typename B>
+        bool operator()(const A& a, const B& b) const { return a < b; }
+    };
+
+    /**
+     * @brief Default comparator for descending order using operator<
+     */
+    struct greater
+    {
+        template <typename A, typename B>
+        bool operator()(const A& a, const B& b) const { return b < a; }
+    };
+
+    namespace detail
+    {
+        // compares the keys of two elements and counts the comparison
+        template <typename Compare, typename Projection>
+        struct KeyCompare
+        {
+            Compare comp;
+            Projection proj;
+            Operation* opCmp;
+
+            template <typename A, typename B>
+            bool operator()(A&& a, B&& b) const
+            {
+                if (opCmp) opCmp->count();
+                return comp(proj(std::forward<A>(a)), proj(std::forward<B>(b)));
+            }
+        };
+
+        template <typename Compare, typename Projection>
+        KeyCompare<Compare, Projection> key_compare(Compare comp, Projection proj, Operation* opCmp)
+        {
+            KeyCompare<Compare, Projection> result = {comp, proj, opCmp};
+            return result;
+        }
+
+        template <typename RandomIt>
+        void counted_swap(RandomIt a, RandomIt b, Operation* opAsg)
+        {
+            using std::swap;
+            if (opAsg) opAsg->count(3);
+            swap(*a, *b);
+        }
+
+        template <typename RandomIt, typename KeyCmp>
+        void insertion_sort(RandomIt first, RandomIt last, const KeyCmp& less, Operation* opAsg)
+        {
+            typedef typename std::iterator_traits<RandomIt>::value_type T;
+            if (first == last) {
+                return;
+            }
+            for (RandomIt i = first + 1; i != last; ++i) {
+                if (!less(*i, *(i - 1))) {
+                    continue; // already in place, no need to take the key out
+                }
+                if (opAsg) opAsg->count();
+                T key = std::move(*i);
+                RandomIt j = i;
+                do {
+                    // shift the greater values right
+                    if (opAsg) opAsg->count();
+                    *j = std::move(*(j - 1));
+                    --j;
+                } while (j != first && less(key, *(j - 1)));
+                if (opAsg) opAsg->count();
+                *j = std::move(key);
+            }
+        }
+
+        // moves the value down from the hole at index i until both children are not greater (max-heap)
+        template <typename RandomIt, typename KeyCmp>
+        void sift_down(RandomIt first, std::ptrdiff_t n, std::ptrdiff_t i, const KeyCmp& less, Operation* opAsg)
+        {
+            typedef typename std::iterator_traits<RandomIt>::value_type T;
+            if (2 * i + 1 >= n) {
+                return;
+            }
+            if (opAsg) opAsg->count();
+            T value = std::move(first[i]);
+            std::ptrdiff_t child;
+            while ((child = 2 * i + 1) < n) {
+                if (child + 1 < n && less(first[child], first[child + 1])) {
+                    child++;
+                }
+                if (!less(value, first[child])) {
+                    break;
+                }
+                if (opAsg) opAsg->count();
+                first[i] = std::move(first[child]);
+                i = child;
+            }
+            if (opAsg) opAsg->count();
+            first[i] = std::move(value);
+        }
+
+        // Floyd's sift for the extractions: the hole at the root goes down to a leaf towards the greater child
+        // (one comparison per level), then value climbs back up from there, usually by a level or two
+        template <typename RandomIt, typename T, typename KeyCmp>
+        void sift_hole(RandomIt first, std::ptrdiff_t n, T&& value, const KeyCmp& less, Operation* opAsg)
+        {
+            std::ptrdiff_t i = 0;
+            std::ptrdiff_t child;
+            while ((child = 2 * i + 1) < n) {
+                if (child + 1 < n && less(first[child], first[child + 1])) {
+                    child++;
+                }
+                if (opAsg) opAsg->count();
+                first[i] = std::move(first[child]);
+                i = child;
+            }
+            while (i > 0) {
+                const std::ptrdiff_t parent = (i - 1) / 2;
+                if (!less(first[parent], value)) {
+                    break;
+                }
+                if (opAsg) opAsg->count();
+                first[i] = std::move(first[parent]);
+                i = parent;
+            }
+            if (opAsg) opAsg->count();
+            first[i] = std::move(value);
+        }
+
+        template <typename RandomIt, typename KeyCmp>
+        void heap_sort(RandomIt first, RandomIt last, const KeyCmp& less, Operation* opAsg)
+        {
+            typedef typename std::iterator_traits<RandomIt>::value_type T;
+            const std::ptrdiff_t n = last - first;
+            for (std::ptrdiff_t i = n / 2 - 1; i >= 0; i--) {
+                sift_down(first, n, i, less, opAsg);
+            }
+            for (std::ptrdiff_t i = n - 1; i > 0; i--) {
+                // the root goes to the end and the last value is sifted in from the root
+                T value = std::move(first[i]);
+                first[i] = std::move(first[0]);
+                if (opAsg) opAsg->count(2);
+                sift_hole(first, i, std::move(value), less, opAsg);
+            }
+        }
+
+        // orders a, b, c so that *a <= *b <= *c
+        template <typename RandomIt, typename KeyCmp>
+        void sort3(RandomIt a, RandomIt b, RandomIt c, const KeyCmp& less, Operation* opAsg)
+        {
+            if (less(*b, *a)) counted_swap(a, b, opAsg);
+            if (less(*c, *b)) {
+                counted_swap(b, c, opAsg);
+                if (less(*b, *a)) counted_swap(a, b, opAsg);
+            }
+        }
+
+        // Hoare partition of [first, last) around the median of the first, middle and last element
+        // the median of three keeps sorted and reverse sorted inputs (e.g. already ordered records) at O(n log n);
+        // both scans stop on keys equal to the pivot, so runs of equal keys (e.g. edges of the same weight) are
+        // split in the middle instead of all going to one side
+        template <typename RandomIt, typename KeyCmp>
+        RandomIt partition(RandomIt first, RandomIt last, const KeyCmp& less, Operation* opAsg)
+        {
+            const RandomIt pivot = last - 1;
+            if (last - first >= 3) {
+                RandomIt mid = first + (last - first) / 2;
+                sort3(first, mid, pivot, less, opAsg);
+                counted_swap(mid, pivot, opAsg); // the median becomes the pivot at the end
+            }
+            RandomIt i = first, j = pivot;
+            for (;;) {
+                // the pivot itself stops the left scan
+                while (less(*i, *pivot)) {
+                    ++i;
+                }
+                while (j != first && less(*pivot, *--j)) {
+                }
+                if (!(i < j)) {
+                    break;
+                }
+                counted_swap(i, j, opAsg);
+                ++i;
+            }
+            if (i != pivot) {
+                counted_swap(i, pivot, opAsg);
+            }
+            return i;
+        }
+
+        template <typename RandomIt, typename KeyCmp>
+        void quick_sort(RandomIt first, RandomIt last, const KeyCmp& less, Operation* opAsg, std::ptrdiff_t threshold)
+        {
+            // recurse on the smaller side and loop on the larger one, so the stack depth stays O(log n)
+            while (last - first > threshold && last - first > 1) {
+                const RandomIt p = partition(first, last, less, opAsg);
+                if (p - first < last - p) {
+                    quick_sort(first, p, less, opAsg, threshold);
+                    first = p + 1;
+                } else {
+                    quick_sort(p + 1, last, less, opAsg, threshold);
+                    last = p;
+                }
+            }
+            insertion_sort(first, last, less, opAsg);
+        }
+    } // namespace detail
+
+    /**
+     * @brief Insertion sort algorithm
+     *
+     * @param first, last range of elements to be sorted
+     * @param comp comparator applied on the projected keys
+     * @param proj projection returning the key of an element
+     * @param opAsg optional counter for assignment operations
+     * @param opCmp optional counter for comparison operations
+     */
+    template <typename RandomIt, typename Compare = less, typename Projection = identity>
+    void insertion_sort(RandomIt first, RandomIt last, Compare comp = Compare(), Projection proj = Projection(),
+                        Operation* opAsg = nullptr, Operation* opCmp = nullptr)
+    {
+        detail::insertion_sort(first, last, detail::key_compare(comp, proj, opCmp), opAsg);
+    }
+
+    /**
+     * @brief Binary insertion sort algorithm, stable, the fewest comparisons of the direct methods
+     *
+     * @param first, last range of elements to be sorted
+     * @param comp comparator applied on the projected keys
+     * @param proj projection returning the key of an element
+     * @param opAsg optional counter for assignment operations
+     * @param opCmp optional counter for comparison operations
+     */
+    template <typename RandomIt, typename Compare = less, typename Projection = identity>
+    void binary_insertion_sort(RandomIt first, RandomIt last, Compare comp = Compare(), Projection proj = Projection(),
+                               Operation* opAsg = nullptr, Operation* opCmp = nullptr)
+    {
+        typedef typename std::iterator_traits<RandomIt>::value_type T;
+        const detail::KeyCompare<Compare, Projection> less = detail::key_compare(comp, proj, opCmp);
+        if (first == last) {
+            return;
+        }
+        for (RandomIt i = first + 1; i != last; ++i) {
+            // upper bound of the key in the sorted prefix [first, i)
+            RandomIt lo = first, hi = i;
+            while (lo < hi) {
+                const RandomIt mid = lo + (hi - lo) / 2;
+                if (less(*i, *mid)) {
+                    hi = mid;
+                } else {
+                    lo = mid + 1;
+                }
+            }
+            if (lo == i) {
+                continue;
+            }
+            if (opAsg) opAsg->count(2 + (i - lo));
+            T key = std::move(*i);
+            std::move_backward(lo, i, i + 1);
+            *lo = std::move(key);
+        }
+    }
+
+    /**
+     * @brief Heap sort algorithm
+     *
+     * @param first, last range of elements to be sorted
+     * @param comp comparator applied on the projected keys
+     * @param proj projection returning the key of an element
+     * @param opAsg optional counter for assignment operations
+     * @param opCmp optional counter for comparison operations
+     */
+    template <typename RandomIt, typename Compare = less, typename Projection = identity>
+    void heap_sort(RandomIt first, RandomIt last, Compare comp = Compare(), Projection proj = Projection(),
+                   Operation* opAsg = nullptr, Operation* opCmp = nullptr)
+    {
+        detail::heap_sort(first, last, detail::key_compare(comp, proj, opCmp), opAsg);
+    }
+
+    /**
+     * @brief Hybridized quick sort algorithm, insertion sort is used on ranges up to threshold elements
+     *
+     * @param first, last range of elements to be sorted
+     * @param comp comparator applied on the projected keys
+     * @param proj projection returning the key of an element
+     * @param opAsg optional counter for assignment operations
+     * @param opCmp optional counter for comparison operations
+     * @param threshold size under which insertion sort is used, 0 for plain quick sort
+     */
+    template <typename RandomIt, typename Compare = less, typename Projection = identity>
+    void quick_sort(RandomIt first, RandomIt last, Compare comp = Compare(), Projection proj = Projection(),
+                    Operation* opAsg = nullptr, Operation* opCmp = nullptr, int threshold = 29)
+    {
+        detail::quick_sort(first, last, detail::key_compare(comp, proj, opCmp), opAsg, threshold);
+    }
+
+    /**
+     * @brief Quick select algorithm, rearranges the range so that nth holds the element that would be there
+     *        if the range was sorted, with no greater element before it and no smaller one after it
+     *
+     * @param first, last range of elements
+     * @param nth position of the requested order statistic
+     * @param comp comparator applied on the projected keys
+     * @param proj projection returning the key of an element
+     * @param opAsg optional counter for assignment operations
+     * @param opCmp optional counter for comparison operations
+     */
+    template <typename RandomIt, typename Compare = less, typename Projection = identity>
+    void quick_select(RandomIt first, RandomIt nth, RandomIt last, Compare comp = Compare(), Projection proj = Projection(),
+                      Operation* opAsg = nullptr, Operation* opCmp = nullptr)
+    {
+        const detail::KeyCompare<Compare, Projection> less = detail::key_compare(comp, proj, opCmp);
+        while (last - first > 3) {
+            const RandomIt p = detail::partition(first, last, less, opAsg);
+            if (p == nth) {
+                return;
+            }
+            if (nth < p) {
+                last = p;
+            } else {
+                first = p + 1;
+            }
+        }
+        detail::insertion_sort(first, last, less, opAsg);
+    }
+
+    /**
+     * @brief Sorting algorithm used underneath argsort
+     */
+    enum Engine { QUICK_SORT, HEAP_SORT };
+
+    /**
+     * @brief Key of an element cached next to its 32-bit index, the unit that argsort moves around
+     */
+    template <typename Key>
+    struct KeyIndex
+    {
+        Key key;
+        std::uint32_t index;
+    };
+
+    namespace detail
+    {
+        // orders by key and breaks ties by index, which makes argsort stable
+        template <typename Compare>
+        struct KeyIndexCompare
+        {
+            Compare comp;
+
+            template <typename Key>
+            bool operator()(const KeyIndex<Key>& a, const KeyIndex<Key>& b) const
+            {
+                if (comp(a.key, b.key)) return true;
+                if (comp(b.key, a.key)) return false;
+                return a.index < b.index;
+            }
+        };
+    } // namespace detail
+
+    /**
+     * @brief Indirect sort, computes the permutation that sorts the range without moving the elements
+     *
+     * Only {key, index} pairs are moved by the sort, so sorting large records costs about as much as sorting
+     * their keys. The result is stable. Use apply_permutation to rearrange the records afterwards.
+     *
+     * @param first, last range of elements, at most 2^32 - 1 of them
+     * @param order output, order[i] is the index of the element that belongs at position i, size last - first
+     * @param comp comparator applied on the projected keys
+     * @param proj projection returning the key of an element, it is called once per element
+     * @param opAsg optional counter for assignment operations
+     * @param opCmp optional counter for comparison operations
+     * @param engine QUICK_SORT (hybridized quick sort) or HEAP_SORT
+     */
+    template <typename RandomIt, typename Compare = less, typename Projection = identity>
+    void argsort(RandomIt first, RandomIt last, std::uint32_t* order, Compare comp = Compare(), Projection proj = Projection(),
+                 Operation* opAsg = nullptr, Operation* opCmp = nullptr, Engine engine = QUICK_SORT)
+    {
+        typedef typename std::decay<decltype(proj(*first))>::type Key;
+        const std::uint32_t n = static_cast<std::uint32_t>(last - first);
+
+        std::vector<KeyIndex<Key> > keys;
+        keys.reserve(n);
+        for (std::uint32_t i = 0; i < n; i++) {
+            KeyIndex<Key> entry = {proj(first[i]), i};
+            keys.push_back(std::move(entry));
+        }
+
+        const detail::KeyIndexCompare<Compare> byKey = {comp};
+        const detail::KeyCompare<detail::KeyIndexCompare<Compare>, identity> less = detail::key_compare(byKey, identity(), opCmp);
+        if (engine == HEAP_SORT) {
+            detail::heap_sort(keys.begin(), keys.end(), less, opAsg);
+        } else {
+            detail::quick_sort(keys.begin(), keys.end(), less, opAsg, 29);
+        }
+
+        for (std::uint32_t i = 0; i < n; i++) {
+            order[i] = keys[i].index;
+        }
+    }
+
+    /**
+     * @brief Rearranges the range in place so that position i receives the element at order[i]
+     *
+     * Follows the cycles of the permutation, every element is moved exactly once (plus one temporary per cycle)
+     * and no second copy of the range is needed. The permutation is consumed, order is the identity afterwards.
+     *
+     * @param first, last range of elements
+     * @param order permutation as computed by argsort, size last - first
+     * @param opAsg optional counter for assignment operations
+     */
+    template <typename RandomIt>
+    void apply_permutation(RandomIt first, RandomIt last, std::uint32_t* order, Operation* opAsg = nullptr)
+    {
+        typedef typename std::iterator_traits<RandomIt>::value_type T;
+        const std::uint32_t n = static_cast<std::uint32_t>(last - first);
+        for (std::uint32_t start = 0; start < n; start++) {
+            if (order[start] == start) {
+                continue;
+            }
+            if (opAsg) opAsg->count();
+            T value = std::move(first[start]);
+            std::uint32_t hole = start;
+            while (order[hole] != start) {
+                const std::uint32_t next = order[hole];
+                if (opAsg) opAsg->count();
+                first[hole] = std::move(first[next]);
+                order[hole] = hole;
+                hole = next;
+            }
+            if (opAsg) opAsg->count();
+            first[hole] = std::move(value);
+            order[hole] = hole;
+        }
+    }
+
+} // namespace sorting
+
+#endif // __SORTING_H__
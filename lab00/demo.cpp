@@ -4,6 +4,7 @@
 
 #include <cstdio>
 #include <cmath>
+#include <vector>
 
 namespace lab00
 {
@@ -41,10 +42,88 @@ double fastPow(double x, int n, Operation* op)
 }
 
 
+double iterativePow(double x, unsigned int e)
+{
+    // square and multiply without recursion, bits of the exponent from the lowest one
+    double y = 1;
+    while (e) {
+        if (e & 1) {
+            y *= x;
+        }
+        x *= x;
+        e >>= 1;
+    }
+    return y;
+}
+
+#ifdef HAS_X86_SIMD
+TARGET_AVX2 void powBatchAvx2(const double* x, double* out, size_t n, unsigned int e)
+{
+    // the exponent is the same for every lane, so the branches only depend on e and are predicted perfectly
+    // two independent vectors are processed at once to hide the latency of the multiplications
+    const size_t vectorEnd = n - n % 8;
+    size_t i = 0;
+    for (; i < vectorEnd; i += 8) {
+        __m256d base0 = _mm256_loadu_pd(x + i);
+        __m256d base1 = _mm256_loadu_pd(x + i + 4);
+        __m256d y0 = _mm256_set1_pd(1.0);
+        __m256d y1 = _mm256_set1_pd(1.0);
+        for (unsigned int k = e; k; k >>= 1) {
+            if (k & 1) {
+                y0 = _mm256_mul_pd(y0, base0);
+                y1 = _mm256_mul_pd(y1, base1);
+            }
+            base0 = _mm256_mul_pd(base0, base0);
+            base1 = _mm256_mul_pd(base1, base1);
+        }
+        _mm256_storeu_pd(out + i, y0);
+        _mm256_storeu_pd(out + i + 4, y1);
+    }
+    for (; i < n; i++) {
+        out[i] = iterativePow(x[i], e);
+    }
+}
+#endif
+
+void pow_batch(const double* x, double* out, size_t n, int e, Operation* op)
+{
+    static const bool avx2 = cpuSupportsAvx2();
+    const unsigned int exponent = e < 0 ? 0u - (unsigned int)e : (unsigned int)e;
+
+    if (op) {
+        // multiplications done for every value: one squaring per bit and one product per set bit
+        int muls = 0;
+        for (unsigned int k = exponent; k; k >>= 1) {
+            muls += 1 + (k & 1);
+        }
+        op->count(muls * (int)n);
+    }
+
+#ifdef HAS_X86_SIMD
+    if (avx2) {
+        powBatchAvx2(x, out, n, exponent);
+    } else
+#endif
+    {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = iterativePow(x[i], exponent);
+        }
+    }
+
+    if (e < 0) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = 1 / out[i];
+        }
+    }
+}
+
 void demonstrate(double x, int n)
 {
     printf("Slow pow(%g, %d) = %g\n", x, n, slowPow(x, n));
     printf("Fast pow(%g, %d) = %g\n", x, n, fastPow(x, n));
+    double y;
+    pow_batch(&x, &y, 1, n);
+    printf("Batch pow(%g, %d) = %g\n", x, n, y);
 }
 
 // Floating point test for equality using a relative epsilon
@@ -77,6 +156,46 @@ TEST_CASE("Power functions")
     }
 }
 
+TEST_CASE("Batch power functions")
+{
+    // sizes that are not multiples of the vector width exercise the scalar tail
+    for (int n = 0; n < 40; n++) {
+        std::vector<double> x(n), out(n);
+        for (int i = 0; i < n; i++) {
+            x[i] = 0.5 + (double)(rand()) / RAND_MAX;
+        }
+        const int e = rand() % 40;
+        pow_batch(x.data(), out.data(), n, e);
+        for (int i = 0; i < n; i++) {
+            REQUIRE( fpAproxEqual(out[i], fastPow(x[i], e)) );
+        }
+
+        pow_batch(x.data(), out.data(), n, -e);
+        for (int i = 0; i < n; i++) {
+            REQUIRE( fpAproxEqual(out[i], 1 / fastPow(x[i], e)) );
+        }
+    }
+
+    double x[5] = {0.5, 1, 2, 3, 1.5};
+    double out[5];
+    pow_batch(x, out, 5, 0);
+    for (int i = 0; i < 5; i++) {
+        REQUIRE( out[i] == 1 );
+    }
+
+    pow_batch<13>(x, out, 5);
+    for (int i = 0; i < 5; i++) {
+        REQUIRE( fpAproxEqual(out[i], fastPow(x[i], 13)) );
+    }
+    pow_batch<0>(x, out, 5);
+    REQUIRE( out[4] == 1 );
+    static_assert(PowUnrolled<10>::apply(2) == 1024, "evaluated at compile time");
+
+    // in place
+    pow_batch(x, x, 5, 2);
+    REQUIRE( x[3] == 9 );
+}
+
 void performance(Profiler& profiler)
 {
     const double x = (double)(rand()) / RAND_MAX * 10;
@@ -118,4 +237,79 @@ void benchmark(Profiler& profiler)
     profiler.createGroup("time", "slow_pow", "fast_pow");
 }
 
+const int BATCH_SIZE = 1 << 14;
+const int BATCH_REPEAT = 500;
+const int MAX_BATCH_EXPONENT = 100;
+
+// the exponent of pow_batch<E> has to be known at compile time, so the sizes are unrolled by templates as well
+template <int E>
+void benchmarkUnrolled(Profiler& profiler, const double* x, double* out)
+{
+    volatile double sink = 0;
+    profiler.startTimer("pow_batch_unrolled", E);
+    for (int j = 0; j < BATCH_REPEAT; ++j) {
+        pow_batch<E>(x, out, BATCH_SIZE);
+        sink = sink + out[j];
+    }
+    profiler.stopTimer("pow_batch_unrolled", E);
+    benchmarkUnrolled<E + 10>(profiler, x, out);
+}
+
+template <>
+void benchmarkUnrolled<MAX_BATCH_EXPONENT + 10>(Profiler&, const double*, double*)
+{
+}
+
+void benchmarkBatch(Profiler& profiler)
+{
+    printf("Benchmarking batch power functions on %d values...\n", BATCH_SIZE);
+    std::vector<double> x(BATCH_SIZE), out(BATCH_SIZE);
+    for (int i = 0; i < BATCH_SIZE; i++) {
+        x[i] = 0.5 + (double)(rand()) / RAND_MAX;
+    }
+
+    volatile double sink = 0; // keeps the results alive
+    for (int e = 0; e <= MAX_BATCH_EXPONENT; e += 10) {
+        printf("e(%d)\n", e);
+        profiler.startTimer("slow_pow", e);
+        for (int j = 0; j < BATCH_REPEAT; ++j) {
+            for (int i = 0; i < BATCH_SIZE; i++) {
+                out[i] = slowPow(x[i], e);
+            }
+            sink = sink + out[j];
+        }
+        profiler.stopTimer("slow_pow", e);
+
+        profiler.startTimer("fast_pow", e);
+        for (int j = 0; j < BATCH_REPEAT; ++j) {
+            for (int i = 0; i < BATCH_SIZE; i++) {
+                out[i] = fastPow(x[i], e);
+            }
+            sink = sink + out[j];
+        }
+        profiler.stopTimer("fast_pow", e);
+
+        profiler.startTimer("std_pow", e);
+        for (int j = 0; j < BATCH_REPEAT; ++j) {
+            for (int i = 0; i < BATCH_SIZE; i++) {
+                out[i] = std::pow(x[i], e);
+            }
+            sink = sink + out[j];
+        }
+        profiler.stopTimer("std_pow", e);
+
+        profiler.startTimer("pow_batch", e);
+        for (int j = 0; j < BATCH_REPEAT; ++j) {
+            pow_batch(x.data(), out.data(), BATCH_SIZE, e);
+            sink = sink + out[j];
+        }
+        profiler.stopTimer("pow_batch", e);
+    }
+    benchmarkUnrolled<0>(profiler, x.data(), out.data());
+
+    profiler.createGroup("batch time", "slow_pow", "fast_pow", "std_pow", "pow_batch", "pow_batch_unrolled");
+    profiler.createGroup("fast batch time", "std_pow", "pow_batch", "pow_batch_unrolled");
+    profiler.showReport();
+}
+
 } // namespace lab00
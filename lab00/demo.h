@@ -2,6 +2,9 @@
 #define __DEMO_H__
 
 #include "Profiler.h"
+#include "cpu_features.h"
+
+#include <cstddef>
 
 namespace lab00
 {
@@ -24,6 +27,116 @@ double slowPow(double x, int n, Operation* op = nullptr);
  */
 double fastPow(double x, int n, Operation* op = nullptr);
 
+/**
+ * @brief Raises every value of an array to the same integer power
+ *
+ * Iterative square and multiply, the exponent is scanned once and applied to 4 values at a time with AVX2
+ * (when the CPU supports it). Negative exponents give 1 / x^-e.
+ *
+ * @param x input values
+ * @param out output values, out[i] = x[i]^e, may be the same array as x
+ * @param n number of values
+ * @param e exponent
+ * @param op optional operation counter (multiplications)
+ */
+void pow_batch(const double* x, double* out, size_t n, int e, Operation* op = nullptr);
+
+/**
+ * @brief x^E for an exponent known at compile time, the square and multiply chain is unrolled by the compiler
+ */
+template <int E>
+struct PowUnrolled
+{
+    static constexpr double squareTimes(double half, double x)
+    {
+        return E % 2 ? half * half * x : half * half;
+    }
+
+    static constexpr double apply(double x)
+    {
+        return squareTimes(PowUnrolled<E / 2>::apply(x), x);
+    }
+};
+
+template <>
+struct PowUnrolled<1>
+{
+    static constexpr double apply(double x) { return x; }
+};
+
+template <>
+struct PowUnrolled<0>
+{
+    static constexpr double apply(double) { return 1; }
+};
+
+#ifdef HAS_X86_SIMD
+/**
+ * @brief x^E on 4 values at once, the same multiplication chain as PowUnrolled
+ */
+template <int E>
+TARGET_AVX2 inline __m256d powUnrolledAvx2(__m256d x)
+{
+    const __m256d half = powUnrolledAvx2<E / 2>(x);
+    const __m256d square = _mm256_mul_pd(half, half);
+    return E % 2 ? _mm256_mul_pd(square, x) : square;
+}
+
+template <>
+TARGET_AVX2 inline __m256d powUnrolledAvx2<1>(__m256d x)
+{
+    return x;
+}
+
+template <>
+TARGET_AVX2 inline __m256d powUnrolledAvx2<0>(__m256d)
+{
+    return _mm256_set1_pd(1.0);
+}
+
+template <int E>
+TARGET_AVX2 void powBatchUnrolledAvx2(const double* x, double* out, size_t n)
+{
+    const size_t vectorEnd = n - n % 8;
+    size_t i = 0;
+    for (; i < vectorEnd; i += 8) {
+        const __m256d y0 = powUnrolledAvx2<E>(_mm256_loadu_pd(x + i));
+        const __m256d y1 = powUnrolledAvx2<E>(_mm256_loadu_pd(x + i + 4));
+        _mm256_storeu_pd(out + i, y0);
+        _mm256_storeu_pd(out + i + 4, y1);
+    }
+    for (; i < n; i++) {
+        out[i] = PowUnrolled<E>::apply(x[i]);
+    }
+}
+#endif
+
+/**
+ * @brief Raises every value of an array to the power E known at compile time
+ *
+ * The loop body is a fixed chain of multiplications without any branch on the exponent,
+ * run on 4 values at a time with AVX2 (when the CPU supports it).
+ *
+ * @param x input values
+ * @param out output values, out[i] = x[i]^E, may be the same array as x
+ * @param n number of values
+ */
+template <int E>
+void pow_batch(const double* x, double* out, size_t n)
+{
+    static_assert(E >= 0, "only non-negative exponents can be unrolled");
+#ifdef HAS_X86_SIMD
+    static const bool avx2 = cpuSupportsAvx2();
+    if (avx2) {
+        powBatchUnrolledAvx2<E>(x, out, n);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) {
+        out[i] = PowUnrolled<E>::apply(x[i]);
+    }
+}
+
 /**
  * @brief Demo code for the power functions
  *
@@ -46,6 +159,13 @@ void performance(Profiler& profiler);
  */
 void benchmark(Profiler& profiler);
 
+/**
+ * @brief Benchmarking for the batch power functions against std::pow, slowPow and fastPow
+ *
+ * @param profiler profiler to use
+ */
+void benchmarkBatch(Profiler& profiler);
+
 } // namespace lab00
 
 #endif // __DEMO_H__
\ No newline at end of file
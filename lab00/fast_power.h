@@ -0,0 +1,241 @@
+#ifndef __FAST_POWER_H__
+#define __FAST_POWER_H__
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace lab00
+{
+
+/**
+ * @brief x raised to the power n in any monoid with O(log n) multiplications
+ *
+ * The monoid gives its identity element with identity() and its associative product with operator()(a, b).
+ * The recursion and the counting of the multiplications are the same as in fastPow.
+ *
+ * @param x value to be used
+ * @param n exponent
+ * @param monoid the multiplication to use
+ * @param op optional operation counter (monoid multiplications)
+ */
+template <typename T, typename Monoid>
+T fast_power(const T& x, unsigned long long n, const Monoid& monoid, Operation* op = nullptr)
+{
+    if (n == 0) {
+        return monoid.identity();
+    } else if (n == 1) {
+        return x;
+    }
+    const T half = fast_power(x, n / 2, monoid, op);
+    const T square = monoid(half, half);
+    if (n % 2 == 0) {
+        if (op) op->count();
+        return square;
+    }
+    if (op) op->count(2);
+    return monoid(square, x);
+}
+
+/**
+ * @brief Numbers with their usual multiplication
+ */
+template <typename T>
+struct Multiplication
+{
+    T identity() const { return T(1); }
+    T operator()(const T& a, const T& b) const { return a * b; }
+};
+
+/**
+ * @brief Scalar arithmetic with the usual + and *, used by the matrix and polynomial products
+ */
+template <typename T>
+struct PlainRing
+{
+    T zero() const { return T(0); }
+    T one() const { return T(1); }
+    T multiplyAdd(const T& acc, const T& a, const T& b) const { return acc + a * b; }
+};
+
+/**
+ * @brief Integers modulo mod, the modulus is at most 2^32 so acc + a * b of residues never overflows 64 bits
+ */
+struct ModRing
+{
+    uint64_t mod;
+
+    uint64_t zero() const { return 0; }
+    uint64_t one() const { return 1 % mod; }
+    uint64_t multiplyAdd(uint64_t acc, uint64_t a, uint64_t b) const { return (acc + a * b) % mod; }
+};
+
+/**
+ * @brief Multiplication of residues modulo mod (at most 2^32)
+ */
+struct ModMultiplication
+{
+    uint64_t mod;
+
+    uint64_t identity() const { return 1 % mod; }
+    uint64_t operator()(uint64_t a, uint64_t b) const { return a * b % mod; }
+};
+
+/**
+ * @brief Square k x k matrix stored row by row
+ */
+template <typename T>
+struct Matrix
+{
+    int k;
+    std::vector<T> a;
+
+    explicit Matrix(int k = 0, const T& value = T()) : k(k), a((size_t)k * k, value) {}
+
+    T& operator()(int i, int j) { return a[(size_t)i * k + j]; }
+    const T& operator()(int i, int j) const { return a[(size_t)i * k + j]; }
+};
+
+/**
+ * @brief Side of the tiles used by multiplyBlocked, three 32 x 32 tiles of 8 byte values fit in the L1 cache
+ */
+constexpr int MATRIX_BLOCK = 32;
+
+/**
+ * @brief c = a * b for k x k row major matrices, tile by tile so the working set stays in the L1 cache
+ *
+ * Inside a tile the loops run in i-p-j order: a[i][p] is kept in a register and the rows of b and c are
+ * walked sequentially.
+ *
+ * @param a left operand
+ * @param b right operand
+ * @param c result, must not overlap a or b
+ * @param k size of the matrices
+ * @param ring scalar arithmetic
+ * @param op optional operation counter (scalar multiplications)
+ */
+template <typename T, typename Ring>
+void multiplyBlocked(const T* a, const T* b, T* c, int k, const Ring& ring, Operation* op = nullptr)
+{
+    std::fill(c, c + (size_t)k * k, ring.zero());
+    for (int ii = 0; ii < k; ii += MATRIX_BLOCK) {
+        const int iEnd = std::min(ii + MATRIX_BLOCK, k);
+        for (int pp = 0; pp < k; pp += MATRIX_BLOCK) {
+            const int pEnd = std::min(pp + MATRIX_BLOCK, k);
+            for (int jj = 0; jj < k; jj += MATRIX_BLOCK) {
+                const int jEnd = std::min(jj + MATRIX_BLOCK, k);
+                for (int i = ii; i < iEnd; i++) {
+                    T* row = c + (size_t)i * k;
+                    for (int p = pp; p < pEnd; p++) {
+                        const T aip = a[(size_t)i * k + p];
+                        const T* brow = b + (size_t)p * k;
+                        for (int j = jj; j < jEnd; j++) {
+                            row[j] = ring.multiplyAdd(row[j], aip, brow[j]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (op) op->count(k * k * k);
+}
+
+/**
+ * @brief Multiplication of k x k matrices over the given scalar ring
+ */
+template <typename T, typename Ring = PlainRing<T>>
+struct MatrixMultiplication
+{
+    int k;
+    Ring ring;
+    Operation* opScalar; // optional, counts the scalar multiplications
+
+    MatrixMultiplication(int k, const Ring& ring = Ring(), Operation* opScalar = nullptr)
+        : k(k), ring(ring), opScalar(opScalar) {}
+
+    Matrix<T> identity() const
+    {
+        Matrix<T> id(k, ring.zero());
+        for (int i = 0; i < k; i++) {
+            id(i, i) = ring.one();
+        }
+        return id;
+    }
+
+    Matrix<T> operator()(const Matrix<T>& a, const Matrix<T>& b) const
+    {
+        Matrix<T> c(k);
+        multiplyBlocked(a.a.data(), b.a.data(), c.a.data(), k, ring, opScalar);
+        return c;
+    }
+};
+
+/**
+ * @brief Multiplication of polynomials (coefficient vectors, lowest degree first) over the given scalar ring
+ *
+ * With terms > 0 the products are truncated modulo x^terms, as needed for powers of generating functions.
+ */
+template <typename T, typename Ring = PlainRing<T>>
+struct PolynomialMultiplication
+{
+    size_t terms;
+    Ring ring;
+
+    PolynomialMultiplication(size_t terms = 0, const Ring& ring = Ring()) : terms(terms), ring(ring) {}
+
+    std::vector<T> identity() const
+    {
+        return std::vector<T>(1, ring.one());
+    }
+
+    std::vector<T> operator()(const std::vector<T>& a, const std::vector<T>& b) const
+    {
+        if (a.empty() || b.empty()) {
+            return std::vector<T>();
+        }
+        size_t size = a.size() + b.size() - 1;
+        if (terms > 0) {
+            size = std::min(size, terms);
+        }
+        std::vector<T> c(size, ring.zero());
+        for (size_t i = 0; i < a.size() && i < size; i++) {
+            for (size_t j = 0; j < b.size() && i + j < size; j++) {
+                c[i + j] = ring.multiplyAdd(c[i + j], a[i], b[j]);
+            }
+        }
+        return c;
+    }
+};
+
+/**
+ * @brief n-th term of a[i] = c[0] * a[i - 1] + ... + c[k - 1] * a[i - k] modulo mod
+ *
+ * The k x k companion matrix of the recurrence is raised to the power n, O(k^3 log n).
+ *
+ * @param coefficients the k coefficients c
+ * @param initial the first k terms a[0], ..., a[k - 1]
+ * @param n index of the wanted term
+ * @param mod modulus, at most 2^32
+ * @param op optional operation counter (scalar multiplications)
+ */
+uint64_t linearRecurrence(const std::vector<uint64_t>& coefficients, const std::vector<uint64_t>& initial,
+                          unsigned long long n, uint64_t mod, Operation* op = nullptr);
+
+/**
+ * @brief Same as linearRecurrence, computing every term up to n one after the other, O(k n)
+ */
+uint64_t linearRecurrenceLoop(const std::vector<uint64_t>& coefficients, const std::vector<uint64_t>& initial,
+                              unsigned long long n, uint64_t mod, Operation* op = nullptr);
+
+/**
+ * @brief Linear loop against matrix power for linear recurrences, and blocked against naive matrix product
+ *
+ * @param profiler profiler to use
+ */
+void benchmarkRecurrence(Profiler& profiler);
+
+} // namespace lab00
+
+#endif // __FAST_POWER_H__
@@ -1,4 +1,6 @@
 #include "demo.h"
+#include "fast_power.h"
+#include "montgomery.h"
 
 #include "commandline.h"
 #include "Profiler.h"
@@ -41,6 +43,24 @@ void bench(const CommandArgs& args)
     profiler.reset();
 }
 
+void benchBatch(const CommandArgs& args)
+{
+    benchmarkBatch(profiler);
+    profiler.reset();
+}
+
+void benchRecurrence(const CommandArgs& args)
+{
+    benchmarkRecurrence(profiler);
+    profiler.reset();
+}
+
+void benchModPow(const CommandArgs& args)
+{
+    benchmarkModPow(profiler);
+    profiler.reset();
+}
+
 int main()
 {
     const std::vector<CommandSpec> commands =
@@ -49,6 +69,9 @@ int main()
         {"test", test, "run unit-tests"},
         {"perf", perf, "run performance analysis"},
         {"bench", bench, "run benchmarks"},
+        {"bench_batch", benchBatch, "run benchmarks of the batch power functions"},
+        {"bench_recurrence", benchRecurrence, "run benchmarks of linear recurrences and matrix products"},
+        {"bench_modpow", benchModPow, "run benchmarks of the modular power functions"},
     };
     return runCommandLoop(commands);
 }
\ No newline at end of file
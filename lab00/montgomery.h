@@ -0,0 +1,116 @@
+#ifndef __MONTGOMERY_H__
+#define __MONTGOMERY_H__
+
+#include "Profiler.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lab00
+{
+
+/**
+ * @brief a * b mod m with a 128 bit product and a 128 bit division
+ */
+uint64_t mulModNaive(uint64_t a, uint64_t b, uint64_t m);
+
+/**
+ * @brief a^e mod m by square and multiply with mulModNaive, the reference for the Montgomery version
+ *
+ * @param a base
+ * @param e exponent
+ * @param m modulus, at least 1
+ * @param op optional operation counter (modular multiplications)
+ */
+uint64_t powModNaive(uint64_t a, uint64_t e, uint64_t m, Operation* op = nullptr);
+
+/**
+ * @brief Modular arithmetic for one odd 64 bit modulus in Montgomery form
+ *
+ * Values are kept as x * 2^64 mod m, so a multiplication is two 64 x 64 -> 128 bit products and a subtraction
+ * instead of a 128 bit division.
+ */
+class Montgomery
+{
+public:
+    /**
+     * @brief Prepares the constants for the modulus
+     *
+     * @param m odd modulus
+     */
+    explicit Montgomery(uint64_t m);
+
+    uint64_t modulus() const { return mod; }
+
+    /**
+     * @brief x * 2^64 mod m
+     */
+    uint64_t toMontgomery(uint64_t x) const { return multiply(x % mod, r2); }
+
+    /**
+     * @brief Inverse of toMontgomery
+     */
+    uint64_t fromMontgomery(uint64_t x) const { return reduce(0, x); }
+
+    /**
+     * @brief Product of two values in Montgomery form, the result is in Montgomery form as well
+     */
+    uint64_t multiply(uint64_t a, uint64_t b) const;
+
+    /**
+     * @brief a^e mod m, scanning the exponent with a sliding window
+     *
+     * @param a base (not in Montgomery form)
+     * @param e exponent
+     * @param op optional operation counter (Montgomery multiplications)
+     */
+    uint64_t pow(uint64_t a, uint64_t e, Operation* op = nullptr) const;
+
+    /**
+     * @brief out[i] = bases[i]^e mod m for many bases and the same exponent
+     *
+     * The windows of the exponent are computed once and 4 bases are advanced together,
+     * so their independent multiplications overlap in the pipeline.
+     *
+     * @param bases input bases (not in Montgomery form)
+     * @param out results, may be the same array as bases
+     * @param n number of bases
+     * @param e exponent
+     */
+    void powBatch(const uint64_t* bases, uint64_t* out, size_t n, uint64_t e) const;
+
+private:
+    // (hi * 2^64 + lo) / 2^64 mod m, for hi * 2^64 + lo < m * 2^64
+    uint64_t reduce(uint64_t hi, uint64_t lo) const;
+
+    uint64_t mod;
+    uint64_t inv; // m^-1 mod 2^64
+    uint64_t r1;  // 2^64 mod m, 1 in Montgomery form
+    uint64_t r2;  // 2^128 mod m
+};
+
+/**
+ * @brief a^e mod m, with Montgomery multiplication for odd moduli and powModNaive for even ones
+ */
+uint64_t powMod(uint64_t a, uint64_t e, uint64_t m);
+
+/**
+ * @brief Deterministic Miller-Rabin primality test for 64 bit numbers
+ */
+bool isPrime(uint64_t n);
+
+/**
+ * @brief Smallest prime greater or equal to n, for sizing hash tables
+ */
+uint64_t nextPrime(uint64_t n);
+
+/**
+ * @brief Naive against Montgomery modular powers, single and batched
+ *
+ * @param profiler profiler to use
+ */
+void benchmarkModPow(Profiler& profiler);
+
+} // namespace lab00
+
+#endif // __MONTGOMERY_H__
@@ -1,6 +1,9 @@
 #include "direct_sort.h"
 
+#include <algorithm>
 #include <climits>
+#include <cmath>
+#include <vector>
 
 #include "catch2.hpp"
 
@@ -48,6 +51,16 @@
  *
  * in terms of total operations all algorithms are quadratic in complexity
  * and selection sort is quadratic in all cases
+ * --------------- SHELL SORT ---------------
+ * shell sort runs insertion sort on elements that are gap apart with decreasing gaps, so it stays
+ * in place and non-recursive but is subquadratic. On a random array of 10000 elements it does
+ * ~191k comparisons and ~247k assignments with the Ciura and Tokuda gaps (~227k / ~275k with Sedgewick's)
+ * compared to ~25M for insertion sort, which puts it in the same range as heap sort from lab02
+ * --------------- MERGE INSERTION SORT ---------------
+ * when comparisons are expensive even binary insertion sort wastes some of them, merge insertion (Ford-Johnson)
+ * stays within the worst case bound sum(ceil(log2(3k/4))), close to log2(n!). For 5000 elements it needs ~54.3k
+ * comparisons against ~59.5k for binary insertion sort, and it does not shift the array, so with a slow
+ * comparator (bench_cmp) it beats both binary insertion sort and std::sort
  */
 
 
@@ -125,7 +138,11 @@ void insertionSort(int* values, int n, Operation* opAsg, Operation* opCmp)
     }
 }
 
-int binary_search(int* values, int left, int right, int key, Operation* opAsg, Operation* opCmp) {
+bool is_less(Comparator less, int a, int b) {
+    return less ? less(a, b) : a < b;
+}
+
+int binary_search(int* values, int left, int right, int key, Operation* opAsg, Operation* opCmp, Comparator less) {
     // we search for the insertion index of the key using binary search
 
     if (left > right) {
@@ -135,20 +152,20 @@ int binary_search(int* values, int left, int right, int key, Operation* opAsg, O
     int mid = (left + right) / 2;
 
     if (opCmp) opCmp->count();
-    if (key < values[mid]) {
-        return binary_search(values, left, mid - 1, key, opAsg, opCmp);
+    if (is_less(less, key, values[mid])) {
+        return binary_search(values, left, mid - 1, key, opAsg, opCmp, less);
     }
 
-    return binary_search(values, mid + 1, right, key, opAsg, opCmp);
+    return binary_search(values, mid + 1, right, key, opAsg, opCmp, less);
 }
 
-void binaryInsertionSort(int* values, int n, Operation* opAsg, Operation* opCmp)
+void binaryInsertionSort(int* values, int n, Operation* opAsg, Operation* opCmp, Comparator less)
 {
     for (int i = 1; i < n; i++) {
         if (opAsg) opAsg->count();
         int key = values[i];
 
-        int x = binary_search(values, 0, i - 1, key, opAsg, opCmp);
+        int x = binary_search(values, 0, i - 1, key, opAsg, opCmp, less);
         // we need to shift all the values
         for (int j = i; j > x; j--) {
             if (opAsg) opAsg->count();
@@ -163,6 +180,181 @@ void binaryInsertionSort(int* values, int n, Operation* opAsg, Operation* opCmp)
     }
 }
 
+std::vector<int> merge_insertion(const int* values, const std::vector<int>& items, Operation* opCmp, Comparator less)
+{
+    // items are indices into values, the result is the order of the positions of items (0..m-1) that sorts them
+    // working on indices means an element is never moved until the very end, only the comparator is called
+    const int m = (int)items.size();
+    std::vector<int> chain;
+    if (m == 0) {
+        return chain;
+    }
+    if (m == 1) {
+        chain.push_back(0);
+        return chain;
+    }
+
+    // step 1: compare the elements pairwise, big[i] and small[i] are positions in items
+    const int half = m / 2;
+    std::vector<int> big(half), small(half), big_items(half);
+    for (int i = 0; i < half; i++) {
+        if (opCmp) opCmp->count();
+        if (is_less(less, values[items[2 * i + 1]], values[items[2 * i]])) {
+            big[i] = 2 * i;
+            small[i] = 2 * i + 1;
+        } else {
+            big[i] = 2 * i + 1;
+            small[i] = 2 * i;
+        }
+        big_items[i] = items[big[i]];
+    }
+
+    // step 2: recursively sort the larger element of every pair
+    const std::vector<int> order = merge_insertion(values, big_items, opCmp, less);
+
+    // step 3: the main chain is b1 < a1 < a2 < ... , b1 needs no comparison since it is smaller than a1
+    chain.reserve(m);
+    chain.push_back(small[order[0]]);
+    for (int k = 0; k < half; k++) {
+        chain.push_back(big[order[k]]);
+    }
+
+    // step 4: insert b2, b3, ... (and the straggler if m is odd) in Jacobsthal order: b3 b2, b5 b4, b11 ... b6, ...
+    // b_k is only searched for in front of a_k, in this order every search runs on at most 2^j - 1 elements
+    const int pending = half + (m % 2); // b1 .. b_pending, b_pending is the straggler if m is odd
+    int prev_t = 1, t = 1;
+    while (t < pending) {
+        const int next_t = t + 2 * prev_t; // Jacobsthal numbers 1, 3, 5, 11, 21, 43, ...
+        prev_t = t;
+        t = next_t;
+        const int group_end = std::min(t, pending);
+        for (int k = group_end; k > prev_t; k--) {
+            const bool straggler = k > half;
+            const int pos = straggler ? m - 1 : small[order[k - 1]];
+            const int key = values[items[pos]];
+
+            // a_k is preceded by a_1 .. a_(k-1) and b_1 .. b_prev_t for sure, only the b's of the current
+            // group that were already inserted can be in front of it as well
+            int hi = (int)chain.size();
+            if (!straggler) {
+                hi = k - 1 + prev_t;
+                while (chain[hi] != big[order[k - 1]]) {
+                    hi++;
+                }
+            }
+            int lo = 0;
+            while (lo < hi) {
+                const int mid = (lo + hi) / 2;
+                if (opCmp) opCmp->count();
+                if (is_less(less, key, values[items[chain[mid]]])) {
+                    hi = mid;
+                } else {
+                    lo = mid + 1;
+                }
+            }
+
+            chain.insert(chain.begin() + lo, pos);
+        }
+    }
+
+    return chain;
+}
+
+void mergeInsertionSort(int* values, int n, Operation* opAsg, Operation* opCmp, Comparator less)
+{
+    if (n < 2) {
+        return;
+    }
+
+    std::vector<int> items(n);
+    for (int i = 0; i < n; i++) {
+        items[i] = i;
+    }
+    const std::vector<int> order = merge_insertion(values, items, opCmp, less);
+
+    // apply the resulting order, every element is moved to a buffer and back exactly once
+    std::vector<int> sorted(n);
+    for (int i = 0; i < n; i++) {
+        sorted[i] = values[order[i]];
+    }
+    CopyArray(values, sorted.data(), n);
+    if (opAsg) opAsg->count(2 * n);
+}
+
+int generate_gaps(int* gaps, int n, GapSequence which)
+{
+    // fills gaps with the increments smaller than n in ascending order and returns how many there are
+    // every sequence starts with 1 so the last pass is a plain insertion sort
+    static const int ciura[] = {1, 4, 10, 23, 57, 132, 301, 701, 1750};
+    int count = 0;
+    switch (which) {
+        case CIURA: {
+            long long h = 1;
+            for (int k = 0; h < n; k++) {
+                gaps[count++] = (int)h;
+                // the empirical sequence is only known up to 1750, it is extended by a factor of 2.25
+                h = k + 1 < 9 ? ciura[k + 1] : (long long)(h * 2.25);
+            }
+            break;
+        }
+        case TOKUDA: {
+            // h_k = ceil(h'_k) where h'_k = 2.25 * h'_(k-1) + 1 and h'_1 = 1
+            double h = 1;
+            while (std::ceil(h) < n) {
+                gaps[count++] = (int)std::ceil(h);
+                h = 2.25 * h + 1;
+            }
+            break;
+        }
+        case SEDGEWICK: {
+            // 1, then 4^k + 3 * 2^(k-1) + 1 for k >= 1
+            long long h = 1;
+            for (int k = 1; h < n; k++) {
+                gaps[count++] = (int)h;
+                h = (1LL << (2 * k)) + 3 * (1LL << (k - 1)) + 1;
+            }
+            break;
+        }
+    }
+    if (count == 0) { // n <= 1, nothing to sort but keep the sequence valid
+        gaps[count++] = 1;
+    }
+    return count;
+}
+
+void shellSort(int* values, int n, Operation* opAsg, Operation* opCmp, GapSequence gaps)
+{
+    // insertion sort over elements that are gap apart, the gap decreasing down to 1
+    // large gaps move elements far in few steps so the final insertion sort pass runs on an almost sorted array
+    int gap_values[64];
+    const int gap_count = generate_gaps(gap_values, n, gaps);
+
+    for (int g = gap_count - 1; g >= 0; g--) {
+        const int gap = gap_values[g];
+        for (int i = gap; i < n; i++) {
+            if (opAsg) opAsg->count();
+            const int key = values[i];
+
+            int j = i;
+            while (j >= gap) {
+                if (opCmp) opCmp->count();
+                if (values[j - gap] <= key) {
+                    break;
+                }
+                // we shift the values right by one gap
+                if (opAsg) opAsg->count();
+                values[j] = values[j - gap];
+                j -= gap;
+            }
+
+            if (j != i) { // key only has to be written back if it moved
+                if (opAsg) opAsg->count();
+                values[j] = key;
+            }
+        }
+    }
+}
+
 void demonstrate(int size)
 {
     auto values = new int[size];
@@ -203,6 +395,13 @@ void demonstrate(int size)
         printf("%i ", values[i]);
     }
 
+    CopyArray(values, values_orig, size);
+    shellSort(values, size);
+    printf("\nSorted using shell sort: ");
+    for (int i = 0; i < size; i++) {
+        printf("%i ", values[i]);
+    }
+
     putchar('\n');
 
     delete[] values;
@@ -251,6 +450,69 @@ TEST_CASE("binaryInsertionSort") {
     REQUIRE( IsSorted(data, 40000) );
 }
 
+TEST_CASE("shellSort") {
+    printf("Testing shellSort with every gap sequence on randomized input of size 40000...\n");
+    int data[100000];
+    const GapSequence sequences[] = {CIURA, TOKUDA, SEDGEWICK};
+    for (GapSequence gaps : sequences) {
+        FillRandomArray(data, 40000);
+        shellSort(data, 40000, nullptr, nullptr, gaps);
+        REQUIRE( IsSorted(data, 40000) );
+    }
+
+    // few unique values and sizes around the first gaps
+    for (int n = 0; n <= 30; n++) {
+        FillRandomArray(data, n, 1, 5);
+        shellSort(data, n, nullptr, nullptr, TOKUDA);
+        REQUIRE( IsSorted(data, n) );
+    }
+}
+
+int fordJohnsonBound(int n) {
+    // worst case comparisons of merge insertion: sum of ceil(log2(3k / 4)) for k = 1..n
+    int total = 0;
+    for (int k = 1; k <= n; k++) {
+        int bits = 0;
+        while ((1 << bits) * 4 < 3 * k) {
+            bits++;
+        }
+        total += bits;
+    }
+    return total;
+}
+
+bool descending(int a, int b) {
+    return a > b;
+}
+
+TEST_CASE("mergeInsertionSort") {
+    printf("Testing mergeInsertionSort on randomized input of size 40000...\n");
+    int data[100000];
+    FillRandomArray(data, 40000);
+    mergeInsertionSort(data, 40000);
+    REQUIRE( IsSorted(data, 40000) );
+
+    // user comparator
+    FillRandomArray(data, 1000);
+    mergeInsertionSort(data, 1000, nullptr, nullptr, descending);
+    for (int i = 1; i < 1000; i++) {
+        REQUIRE( data[i - 1] >= data[i] );
+    }
+
+    // never more comparisons than the Ford-Johnson worst case bound, 66 for n = 21
+    REQUIRE( fordJohnsonBound(21) == 66 );
+    Profiler p("merge insertion");
+    for (int n = 0; n <= 64; n++) {
+        for (int rep = 0; rep < 20; rep++) {
+            Operation opCmp = p.createOperation("cmp", n * 100 + rep);
+            FillRandomArray(data, n, 1, n + 10);
+            mergeInsertionSort(data, n, nullptr, &opCmp);
+            REQUIRE( IsSorted(data, n) );
+            REQUIRE( opCmp.get() <= fordJohnsonBound(n) );
+        }
+    }
+}
+
 void performance(Profiler& profiler, AnalysisCase whichCase)
 {
     switch (whichCase) {
@@ -283,6 +545,30 @@ void performance(Profiler& profiler, AnalysisCase whichCase)
 
                     CopyArray(values_to_be_sorted, values, n);
                     binaryInsertionSort(values_to_be_sorted, n, &binInsertionAsg, &binInsertionCmp);
+
+                    Operation mergeInsertionAsg = profiler.createOperation("mergeInsertionAsg", n);
+                    Operation mergeInsertionCmp = profiler.createOperation("mergeInsertionCmp", n);
+
+                    CopyArray(values_to_be_sorted, values, n);
+                    mergeInsertionSort(values_to_be_sorted, n, &mergeInsertionAsg, &mergeInsertionCmp);
+
+                    Operation shellCiuraAsg = profiler.createOperation("shellCiuraAsg", n);
+                    Operation shellCiuraCmp = profiler.createOperation("shellCiuraCmp", n);
+
+                    Operation shellTokudaAsg = profiler.createOperation("shellTokudaAsg", n);
+                    Operation shellTokudaCmp = profiler.createOperation("shellTokudaCmp", n);
+
+                    Operation shellSedgewickAsg = profiler.createOperation("shellSedgewickAsg", n);
+                    Operation shellSedgewickCmp = profiler.createOperation("shellSedgewickCmp", n);
+
+                    CopyArray(values_to_be_sorted, values, n);
+                    shellSort(values_to_be_sorted, n, &shellCiuraAsg, &shellCiuraCmp, CIURA);
+
+                    CopyArray(values_to_be_sorted, values, n);
+                    shellSort(values_to_be_sorted, n, &shellTokudaAsg, &shellTokudaCmp, TOKUDA);
+
+                    CopyArray(values_to_be_sorted, values, n);
+                    shellSort(values_to_be_sorted, n, &shellSedgewickAsg, &shellSedgewickCmp, SEDGEWICK);
                 }
             }
 
@@ -301,6 +587,25 @@ void performance(Profiler& profiler, AnalysisCase whichCase)
             profiler.divideValues("insertionCmp", 5);
             profiler.divideValues("binInsertionAsg", 5);
             profiler.divideValues("binInsertionCmp", 5);
+
+            // only the comparisons are interesting for merge insertion, it is meant for expensive comparators
+            profiler.createGroup("Comparison frugal sorts", "binInsertionCmp", "mergeInsertionCmp");
+            profiler.divideValues("mergeInsertionAsg", 5);
+            profiler.divideValues("mergeInsertionCmp", 5);
+
+            // shell sort is subquadratic, its counts are on the same scale as lab02's heapAsg/heapCmp series
+            profiler.addSeries("shellCiuraOp", "shellCiuraAsg", "shellCiuraCmp");
+            profiler.addSeries("shellTokudaOp", "shellTokudaAsg", "shellTokudaCmp");
+            profiler.addSeries("shellSedgewickOp", "shellSedgewickAsg", "shellSedgewickCmp");
+            profiler.createGroup("Shell sort assignments", "shellCiuraAsg", "shellTokudaAsg", "shellSedgewickAsg");
+            profiler.createGroup("Shell sort comparisons", "shellCiuraCmp", "shellTokudaCmp", "shellSedgewickCmp");
+            profiler.createGroup("Shell sort operations", "shellCiuraOp", "shellTokudaOp", "shellSedgewickOp");
+            profiler.divideValues("shellCiuraAsg", 5);
+            profiler.divideValues("shellCiuraCmp", 5);
+            profiler.divideValues("shellTokudaAsg", 5);
+            profiler.divideValues("shellTokudaCmp", 5);
+            profiler.divideValues("shellSedgewickAsg", 5);
+            profiler.divideValues("shellSedgewickCmp", 5);
             break;
         }
         case BEST: {
@@ -412,8 +717,87 @@ void performance(Profiler& profiler, AnalysisCase whichCase)
 
 void benchmark(Profiler& profiler, AnalysisCase whichCase)
 {
-    // TODO: Write your benchmarks here, as explained in the readme
-    // You should use profiler.startTimer/stopTimer for measuring and plotting measured time
+    // running times of insertion sort and shell sort with each gap sequence
+    // the input is generated according to the selected case
+    const int sorted = whichCase == BEST ? ASCENDING : whichCase == WORST ? DESCENDING : UNSORTED;
+    int values[10000], values_to_be_sorted[10000];
+    for (int n = 500; n <= 10000; n += 500) {
+        printf("size n(%d)\n", n);
+        FillRandomArray(values, n, 10, 50000, false, sorted);
+
+        profiler.startTimer("insertionSort", n);
+        for (int i = 0; i < 100; i++) { // execution time measured across many runs
+            CopyArray(values_to_be_sorted, values, n);
+            insertionSort(values_to_be_sorted, n);
+        }
+        profiler.stopTimer("insertionSort", n);
+
+        profiler.startTimer("shellCiura", n);
+        for (int i = 0; i < 100; i++) {
+            CopyArray(values_to_be_sorted, values, n);
+            shellSort(values_to_be_sorted, n, nullptr, nullptr, CIURA);
+        }
+        profiler.stopTimer("shellCiura", n);
+
+        profiler.startTimer("shellTokuda", n);
+        for (int i = 0; i < 100; i++) {
+            CopyArray(values_to_be_sorted, values, n);
+            shellSort(values_to_be_sorted, n, nullptr, nullptr, TOKUDA);
+        }
+        profiler.stopTimer("shellTokuda", n);
+
+        profiler.startTimer("shellSedgewick", n);
+        for (int i = 0; i < 100; i++) {
+            CopyArray(values_to_be_sorted, values, n);
+            shellSort(values_to_be_sorted, n, nullptr, nullptr, SEDGEWICK);
+        }
+        profiler.stopTimer("shellSedgewick", n);
+    }
+    profiler.createGroup("runTimes", "insertionSort", "shellCiura", "shellTokuda", "shellSedgewick");
+    profiler.createGroup("shellRunTimes", "shellCiura", "shellTokuda", "shellSedgewick");
+    profiler.showReport();
+}
+
+// a comparator that costs about as much as comparing multi-field record keys
+bool slowLess(int a, int b) {
+    volatile unsigned int sink = 0;
+    for (int i = 0; i < 200; i++) {
+        sink = sink * 31 + i;
+    }
+    return a < b;
+}
+
+void benchmarkSlowComparator(Profiler& profiler)
+{
+    printf("Comparing merge insertion sort, binary insertion sort and std::sort with a slow comparator\n");
+    int values[5000], values_to_be_sorted[5000];
+    for (int n = 250; n <= 5000; n += 250) {
+        printf("size n(%d)\n", n);
+        FillRandomArray(values, n);
+
+        profiler.startTimer("mergeInsertion", n);
+        for (int i = 0; i < 10; i++) {
+            CopyArray(values_to_be_sorted, values, n);
+            mergeInsertionSort(values_to_be_sorted, n, nullptr, nullptr, slowLess);
+        }
+        profiler.stopTimer("mergeInsertion", n);
+
+        profiler.startTimer("binaryInsertion", n);
+        for (int i = 0; i < 10; i++) {
+            CopyArray(values_to_be_sorted, values, n);
+            binaryInsertionSort(values_to_be_sorted, n, nullptr, nullptr, slowLess);
+        }
+        profiler.stopTimer("binaryInsertion", n);
+
+        profiler.startTimer("stdSort", n);
+        for (int i = 0; i < 10; i++) {
+            CopyArray(values_to_be_sorted, values, n);
+            std::sort(values_to_be_sorted, values_to_be_sorted + n, slowLess);
+        }
+        profiler.stopTimer("stdSort", n);
+    }
+    profiler.createGroup("slowComparatorTimes", "mergeInsertion", "binaryInsertion", "stdSort");
+    profiler.showReport();
 }
 
 } // namespace lab01
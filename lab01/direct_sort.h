@@ -37,6 +37,11 @@ void selectionSort(int* values, int n, Operation* opAsg = nullptr, Operation* op
  */
 void insertionSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr);
 
+/**
+ * @brief Strict ordering used by the sorts that accept a user comparator, nullptr means a < b
+ */
+typedef bool (*Comparator)(int a, int b);
+
 /**
  * @brief Binary Insertion sort algorithm (insertion sort with binary search)
  *
@@ -44,8 +49,42 @@ void insertionSort(int* values, int n, Operation* opAsg = nullptr, Operation* op
  * @param n number of values in the input array
  * @param opAsg optional counter for assignment operations
  * @param opCmp optional counter for comparison operations
+ * @param less optional comparator, defaults to ascending order
+ */
+void binaryInsertionSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr, Comparator less = nullptr);
+
+/**
+ * @brief Merge insertion sort (Ford-Johnson), the sort with the fewest comparisons in the worst case
+ *
+ * Pairs are compared, the larger halves are sorted recursively and the smaller halves are binary inserted
+ * in Jacobsthal order, so that every binary search runs on a chain of length 2^k - 1.
+ * Meant for expensive comparators, the elements themselves are only moved once at the end.
+ *
+ * @param values array of input values to be sorted
+ * @param n number of values in the input array
+ * @param opAsg optional counter for assignment operations
+ * @param opCmp optional counter for comparison operations (calls of the comparator)
+ * @param less optional comparator, defaults to ascending order
+ */
+void mergeInsertionSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr, Comparator less = nullptr);
+
+/**
+ * @brief Gap sequences available for shell sort
+ */
+enum GapSequence { CIURA, TOKUDA, SEDGEWICK };
+
+/**
+ * @brief Shell sort algorithm (insertion sort over a decreasing sequence of gaps)
+ *
+ * In place, non-recursive and without heap allocations, the gaps are generated on the stack.
+ *
+ * @param values array of input values to be sorted
+ * @param n number of values in the input array
+ * @param opAsg optional counter for assignment operations
+ * @param opCmp optional counter for comparison operations
+ * @param gaps gap sequence to use, one of CIURA, TOKUDA or SEDGEWICK
  */
-void binaryInsertionSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr);
+void shellSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr, GapSequence gaps = CIURA);
 
 /**
  * @brief Demo code for the sorting algorithms
@@ -70,6 +109,13 @@ void performance(Profiler& profiler, AnalysisCase whichCase);
  */
 void benchmark(Profiler& profiler, AnalysisCase whichCase);
 
+/**
+ * @brief Benchmarking of the comparison-frugal sorts using a deliberately slow comparator
+ *
+ * @param profiler profiler to use
+ */
+void benchmarkSlowComparator(Profiler& profiler);
+
 } // namespace lab01
 
 #endif // __DIRECT_SORT_H__
\ No newline at end of file
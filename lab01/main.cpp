@@ -39,6 +39,12 @@ void bench(const CommandArgs& args)
     profiler.reset();
 }
 
+void benchCmp(const CommandArgs& args)
+{
+    benchmarkSlowComparator(profiler);
+    profiler.reset();
+}
+
 int main()
 {
     const std::vector<CommandSpec> commands =
@@ -47,6 +53,7 @@ int main()
         {"test", test, "run unit-tests"},
         {"perf", perf, "[avg(default)|best|worst] - run performance analysis on selected case"},
         {"bench", bench, "[avg(default)|best|worst] - run benchmarks on selected case"},
+        {"bench_cmp", benchCmp, "run benchmarks of the comparison frugal sorts with a slow comparator"},
     };
     return runCommandLoop(commands);
 }
\ No newline at end of file
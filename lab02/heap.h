@@ -58,6 +58,16 @@ namespace lab02
      */
     void heapSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr);
 
+    /**
+     * @brief Heap sort with Floyd's bottom-up sift: the hole left by the root is moved down to a leaf with
+     * one comparison per level, then the displaced value climbs back up from there
+     *
+     * @param values array of input values to be sorted
+     * @param n number of values in the input array
+     * @param opAsg optional counter for assignment operations
+     * @param opCmp optional counter for comparison operations
+     */
+    void floydHeapSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr);
 
     /**
      * @brief Demo code for the sorting algorithms
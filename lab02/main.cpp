@@ -1,4 +1,5 @@
 #include "heap.h"
+#include "priority_queue.h"
 
 #define CATCH_CONFIG_RUNNER
 #include "catch2.hpp"
@@ -39,6 +40,27 @@ void bench(const CommandArgs& args)
     profiler.reset();
 }
 
+void benchPriorityQueues(const CommandArgs& args)
+{
+    const int maxSize = args.empty()? 10000000: atoi(args[0]);
+    benchmarkPriorityQueues(profiler, maxSize);
+    profiler.reset();
+}
+
+void benchDijkstra(const CommandArgs& args)
+{
+    const int maxVertices = args.empty()? 1000000: atoi(args[0]);
+    benchmarkDijkstra(profiler, maxVertices);
+    profiler.reset();
+}
+
+void benchMinMax(const CommandArgs& args)
+{
+    const int n = args.empty()? 4000000: atoi(args[0]);
+    benchmarkMinMaxHeap(profiler, n);
+    profiler.reset();
+}
+
 int main()
 {
     const std::vector<CommandSpec> commands =
@@ -47,6 +69,9 @@ int main()
         {"test", test, "run unit-tests"},
         {"perf", perf, "[avg(default)|best|worst] - run performance analysis on selected case"},
         {"bench", bench, "[avg(default)|best|worst] - run benchmarks on selected case"},
+        {"bench_pq", benchPriorityQueues, "[max size(default 10^7)] - run benchmarks of the priority queues"},
+        {"bench_dijkstra", benchDijkstra, "[max vertices(default 10^6)] - run benchmarks of Dijkstra with every heap"},
+        {"bench_minmax", benchMinMax, "[stream length(default 4*10^6)] - run benchmarks of the min-max heap"},
     };
     return runCommandLoop(commands);
 }
@@ -0,0 +1,758 @@
+#include "priority_queue.h"
+#include "heap.h"
+
+#include "catch2.hpp"
+#include "dary_heap.h"
+#include "indexed_heap.h"
+#include "minmax_heap.h"
+#include "radix_heap.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+ * ---------- D-ARY HEAPS ----------
+ * A binary heap of 10^7 ints is 23 levels deep and a pop misses the cache on nearly every level below the first
+ * few. With 4 children per node the heap is half as deep, and since the 4 children are one aligned 16 byte block
+ * the extra comparisons read memory that is already in the cache. With 8 children (one 32 byte block) the depth
+ * drops by another third but the 7 comparisons per level start to cost more than the misses they save.
+ * Building and draining 1-2 million random ints (the heap fits in the L2/L3 caches): std::priority_queue ~0.22 s,
+ * DaryHeap<2> ~0.23 s, DaryHeap<4> ~0.16 s, DaryHeap<8> ~0.19 s per million. At 10^7 and above every variant
+ * spends its time waiting for memory and the times (3.3-4.5 s for 10^7, lab02 heap sort included) are within the
+ * noise of the machine. The pop follows the branch predictor down the tree, so the next level is already being
+ * loaded while the children are compared; a branch free child selection (cmov) waits for every load and is 2-3 times
+ * slower at 10^7. Pushing random values is cheap for every variant (they rarely climb more than a level or two),
+ * so the pops decide the push-then-drain times as well.
+ *
+ * ---------- RADIX HEAP ----------
+ * Dijkstra only pops keys in increasing order, so the queue does not need to compare keys against each other: the
+ * radix heap files every key under the highest bit where it differs from the last popped key, and only the bucket
+ * that gets emptied is scanned for its minimum. With weights up to 3600 the distances stay below 2^24, a key is
+ * moved at most ~24 times and these moves are sequential reads and appends instead of jumps through a tree.
+ * Random graphs with 4 edges per vertex: for 10^6 vertices std::priority_queue ~0.81 s, DaryHeap<2> ~0.80 s,
+ * IndexedHeap<2> with decrease-key ~0.92 s and RadixHeap ~0.28 s; for 2*10^6 vertices 2.0 s, 1.8 s, 2.6 s and 0.6 s.
+ * Decrease-key saves the duplicate entries, but keeping the positions array up to date costs a random write per move
+ * and does not pay off on sparse graphs.
+ *
+ * ---------- MIN-MAX HEAP ----------
+ * Keeping the best N values of a stream needs the worst one (to evict it) and the best one (to read it). The
+ * min-max heap stores every value once. Two heaps store it twice and a value popped from one of them stays in the
+ * other, marked dead, until it reaches the top or the heap is compacted. A stream of 4*10^6 random values, times in
+ * ms for N = 10^3 / 10^5 / 10^6: min-max heap 14 / 92 / 580, paired heaps 20 / 106 / 730, std::multiset
+ * 17 / 253 / 4011. Below ~10^4 most values are dropped after one comparison with the maximum and the three are even.
+ * The node based multiset falls behind as soon as it leaves the cache.
+ * Draining from both ends in turn, the min-max heap is as fast as the two std heaps (537 against 464 ms for 10^6
+ * values) with half of the memory. It compares up to 6 children and grandchildren per two levels, but moves
+ * half as many times. std::multiset needs 1478 ms.
+ */
+
+namespace lab02
+{
+    template <int D>
+    void checkDrain(const std::vector<int>& values)
+    {
+        std::vector<int> expected(values);
+        std::sort(expected.begin(), expected.end(), std::greater<int>());
+
+        heaps::DaryHeap<int, D> built(values.begin(), values.end());
+        heaps::DaryHeap<int, D> pushed;
+        for (int v : values) {
+            pushed.push(v);
+        }
+        REQUIRE( built.size() == values.size() );
+        for (int v : expected) {
+            REQUIRE( built.top() == v );
+            REQUIRE( pushed.top() == v );
+            built.pop();
+            pushed.pop();
+        }
+        REQUIRE( built.empty() );
+        REQUIRE( pushed.empty() );
+    }
+
+    TEST_CASE("D-ary heap")
+    {
+        for (int n = 0; n < 50; n++) {
+            std::vector<int> values(n);
+            FillRandomArray(values.data(), n, 1, 20);
+            checkDrain<2>(values);
+            checkDrain<3>(values);
+            checkDrain<4>(values);
+            checkDrain<8>(values);
+        }
+        std::vector<int> values(20000);
+        FillRandomArray(values.data(), 20000);
+        checkDrain<4>(values);
+        checkDrain<8>(values);
+
+        // min-heap, pushes interleaved with pops and a second bulk build on a non-empty heap
+        heaps::DaryHeap<int, 4, std::greater<int>> minHeap;
+        std::priority_queue<int, std::vector<int>, std::greater<int>> reference;
+        for (int i = 0; i < 5000; i++) {
+            const int v = rand() % 1000;
+            minHeap.push(v);
+            reference.push(v);
+            if (i % 3 == 0) {
+                REQUIRE( minHeap.top() == reference.top() );
+                minHeap.pop();
+                reference.pop();
+            }
+        }
+        minHeap.build(values.begin(), values.begin() + 1000);
+        for (int i = 0; i < 1000; i++) {
+            reference.push(values[i]);
+        }
+        while (!reference.empty()) {
+            REQUIRE( minHeap.top() == reference.top() );
+            minHeap.pop();
+            reference.pop();
+        }
+        REQUIRE( minHeap.empty() );
+
+        // elements that can only be moved
+        heaps::DaryHeap<std::unique_ptr<std::string>, 8, std::function<bool(const std::unique_ptr<std::string>&,
+                                                                           const std::unique_ptr<std::string>&)>>
+            strings([](const std::unique_ptr<std::string>& a, const std::unique_ptr<std::string>& b) { return *a < *b; });
+        const char* words[] = {"heap", "tree", "node", "leaf", "root", "child", "parent", "key", "pop"};
+        for (const char* word : words) {
+            strings.push(std::unique_ptr<std::string>(new std::string(word)));
+        }
+        REQUIRE( *strings.top() == "tree" );
+        strings.pop();
+        REQUIRE( *strings.top() == "root" );
+    }
+
+    TEST_CASE("Indexed heap")
+    {
+        // random pushes, pops and decreases against an ordered set of (key, id)
+        const int n = 2000;
+        heaps::IndexedHeap<int> heap(n);
+        std::set<std::pair<int, int>> reference;
+        std::vector<int> keys(n);
+        for (int step = 0; step < 50000; step++) {
+            const int id = rand() % n;
+            const int op = rand() % 3;
+            if (op == 0 && !heap.contains(id)) {
+                keys[id] = rand() % 100000;
+                heap.push(id, keys[id]);
+                reference.insert(std::make_pair(keys[id], id));
+            } else if (op == 1 && heap.contains(id)) {
+                reference.erase(std::make_pair(keys[id], id));
+                keys[id] -= rand() % 1000;
+                heap.decrease_key(id, keys[id]);
+                reference.insert(std::make_pair(keys[id], id));
+            } else if (op == 2 && !heap.empty()) {
+                REQUIRE( heap.top_key() == reference.begin()->first );
+                const int popped = heap.pop_min();
+                REQUIRE( keys[popped] == reference.begin()->first );
+                reference.erase(std::make_pair(keys[popped], popped));
+                REQUIRE( !heap.contains(popped) );
+            }
+            REQUIRE( heap.size() == (int)reference.size() );
+        }
+        for (int id = 0; id < n; id++) {
+            if (heap.contains(id)) {
+                REQUIRE( heap.key(id) == keys[id] );
+                REQUIRE( heap.position(id) < heap.size() );
+            } else {
+                REQUIRE( heap.position(id) == -1 );
+            }
+        }
+        heap.clear();
+        REQUIRE( heap.empty() );
+        REQUIRE( !heap.contains(0) );
+
+        // Dijkstra on a random directed graph against Floyd-Warshall
+        const int V = 60;
+        std::vector<std::vector<std::pair<int, int>>> adj(V);
+        std::vector<int> all(V * V, INT_MAX / 2);
+        for (int v = 0; v < V; v++) {
+            all[v * V + v] = 0;
+        }
+        for (int e = 0; e < 400; e++) {
+            const int u = rand() % V, v = rand() % V, w = 1 + rand() % 100;
+            adj[u].push_back(std::make_pair(v, w));
+            all[u * V + v] = std::min(all[u * V + v], w);
+        }
+        for (int k = 0; k < V; k++) {
+            for (int i = 0; i < V; i++) {
+                for (int j = 0; j < V; j++) {
+                    all[i * V + j] = std::min(all[i * V + j], all[i * V + k] + all[k * V + j]);
+                }
+            }
+        }
+        std::vector<int> dist(V, INT_MAX / 2);
+        heaps::IndexedHeap<int, 2> queue(V);
+        dist[0] = 0;
+        queue.push(0, 0);
+        while (!queue.empty()) {
+            const int u = queue.pop_min();
+            for (const std::pair<int, int>& edge : adj[u]) {
+                if (dist[u] + edge.second < dist[edge.first]) {
+                    dist[edge.first] = dist[u] + edge.second;
+                    queue.push_or_decrease(edge.first, dist[edge.first]);
+                }
+            }
+        }
+        for (int v = 0; v < V; v++) {
+            REQUIRE( dist[v] == all[v] );
+        }
+    }
+
+    TEST_CASE("Radix heap")
+    {
+        // monotone workload: every pushed key is at least the last popped one
+        heaps::RadixHeap<int> heap;
+        std::priority_queue<std::pair<unsigned, int>, std::vector<std::pair<unsigned, int>>,
+                            std::greater<std::pair<unsigned, int>>> reference;
+        unsigned last = 0;
+        for (int step = 0; step < 100000; step++) {
+            if (rand() % 3 != 0 || reference.empty()) {
+                const unsigned key = last + rand() % 5000;
+                heap.push(key, step);
+                reference.push(std::make_pair(key, step));
+            } else {
+                REQUIRE( heap.top_key() == reference.top().first );
+                last = heap.top_key();
+                heap.pop();
+                reference.pop();
+                REQUIRE( heap.last_key() == last );
+            }
+            REQUIRE( heap.size() == reference.size() );
+        }
+        while (!reference.empty()) {
+            REQUIRE( heap.top_key() == reference.top().first );
+            heap.pop();
+            reference.pop();
+        }
+        REQUIRE( heap.empty() );
+
+        // 64 bit keys, duplicates and keys that differ only in the highest bit
+        heaps::RadixHeap<std::string, std::uint64_t> wide;
+        wide.push(1ull << 63, "high");
+        wide.push(5, "five");
+        wide.push(5, "five again");
+        wide.push(0, "zero");
+        REQUIRE( wide.top() == "zero" );
+        wide.pop();
+        REQUIRE( wide.top_key() == 5 );
+        wide.pop();
+        REQUIRE( wide.top_key() == 5 );
+        wide.pop();
+        REQUIRE( wide.top() == "high" );
+        wide.pop();
+        REQUIRE( wide.empty() );
+    }
+
+    TEST_CASE("Min-max heap")
+    {
+        // random pushes and pops at both ends checked against std::multiset
+        heaps::MinMaxHeap<int> heap;
+        std::multiset<int> reference;
+        for (int step = 0; step < 50000; step++) {
+            const int action = rand() % 5;
+            if (action < 3 || reference.empty()) {
+                const int value = rand() % 1000;
+                heap.push(value);
+                reference.insert(value);
+            } else if (action == 3) {
+                REQUIRE( heap.min() == *reference.begin() );
+                heap.pop_min();
+                reference.erase(reference.begin());
+            } else {
+                REQUIRE( heap.max() == *reference.rbegin() );
+                heap.pop_max();
+                reference.erase(std::prev(reference.end()));
+            }
+            REQUIRE( heap.size() == reference.size() );
+            if (!reference.empty()) {
+                REQUIRE( heap.min() == *reference.begin() );
+                REQUIRE( heap.max() == *reference.rbegin() );
+            }
+        }
+
+        // bulk build, drained from both ends
+        for (int n = 0; n < 200; n++) {
+            std::vector<int> values(n);
+            FillRandomArray(values.data(), n, 0, 50);
+            heaps::MinMaxHeap<int> built(values.begin(), values.end());
+            std::sort(values.begin(), values.end());
+            int low = 0, high = n - 1;
+            while (low <= high) {
+                REQUIRE( built.max() == values[high--] );
+                built.pop_max();
+                if (low <= high) {
+                    REQUIRE( built.min() == values[low++] );
+                    built.pop_min();
+                }
+            }
+            REQUIRE( built.empty() );
+        }
+
+        // bounded: the 100 smallest values of the stream are kept
+        heaps::MinMaxHeap<int> best(100);
+        std::vector<int> stream(10000);
+        FillRandomArray(stream.data(), (int)stream.size(), 0, 100000);
+        for (int value : stream) {
+            best.push(value);
+            REQUIRE( best.size() <= 100 );
+        }
+        std::sort(stream.begin(), stream.end());
+        for (int i = 0; i < 100; i++) {
+            REQUIRE( best.min() == stream[i] );
+            best.pop_min();
+        }
+        REQUIRE( best.empty() );
+    }
+
+    template <int D>
+    void benchmarkDary(Profiler& profiler, const std::vector<int>& values, const char* buildName, const char* pushName)
+    {
+        const int n = (int)values.size();
+        volatile int sink = 0;
+
+        profiler.startTimer(buildName, n);
+        {
+            heaps::DaryHeap<int, D> heap(values.begin(), values.end());
+            while (!heap.empty()) {
+                sink = sink + heap.top();
+                heap.pop();
+            }
+        }
+        profiler.stopTimer(buildName, n);
+
+        profiler.startTimer(pushName, n);
+        {
+            heaps::DaryHeap<int, D> heap;
+            heap.reserve(n);
+            for (int v : values) {
+                heap.push(v);
+            }
+            while (!heap.empty()) {
+                sink = sink + heap.top();
+                heap.pop();
+            }
+        }
+        profiler.stopTimer(pushName, n);
+    }
+
+    void benchmarkPriorityQueues(Profiler& profiler, int maxSize)
+    {
+        const int sizes[] = {1000000, 2000000, 5000000, 10000000, 20000000, 50000000, 100000000};
+        volatile int sink = 0;
+        for (int n : sizes) {
+            if (n > maxSize) {
+                break;
+            }
+            printf("size n(%d)\n", n);
+            std::vector<int> values(n), data;
+            FillRandomArray(values.data(), n, 0, 1000000000);
+
+            data = values;
+            profiler.startTimer("lab02_heapSort", n);
+            heapSort(data.data(), n);
+            profiler.stopTimer("lab02_heapSort", n);
+
+            profiler.startTimer("std_build", n);
+            {
+                std::priority_queue<int> heap(values.begin(), values.end());
+                while (!heap.empty()) {
+                    sink = sink + heap.top();
+                    heap.pop();
+                }
+            }
+            profiler.stopTimer("std_build", n);
+
+            profiler.startTimer("std_push", n);
+            {
+                std::vector<int> container;
+                container.reserve(n);
+                std::priority_queue<int> heap(std::less<int>(), std::move(container));
+                for (int v : values) {
+                    heap.push(v);
+                }
+                while (!heap.empty()) {
+                    sink = sink + heap.top();
+                    heap.pop();
+                }
+            }
+            profiler.stopTimer("std_push", n);
+
+            benchmarkDary<2>(profiler, values, "dary2_build", "dary2_push");
+            benchmarkDary<4>(profiler, values, "dary4_build", "dary4_push");
+            benchmarkDary<8>(profiler, values, "dary8_build", "dary8_push");
+        }
+        profiler.createGroup("Build and drain", "lab02_heapSort", "std_build", "dary2_build", "dary4_build", "dary8_build");
+        profiler.createGroup("Push and drain", "std_push", "dary2_push", "dary4_push", "dary8_push");
+        profiler.showReport();
+    }
+
+    // directed graph in one array: the edges leaving v are targets[start[v]] ... targets[start[v + 1] - 1]
+    struct WeightedGraph {
+        std::vector<int> start, targets, weights;
+    };
+
+    void generateGraph(WeightedGraph& graph, const int V, const int E)
+    {
+        std::vector<int> from(E);
+        graph.start.assign(V + 1, 0);
+        for (int e = 0; e < E; e++) {
+            // the first V edges make a cycle so every vertex is reachable
+            from[e] = e < V ? e : rand() % V;
+            graph.start[from[e] + 1]++;
+        }
+        for (int v = 0; v < V; v++) {
+            graph.start[v + 1] += graph.start[v];
+        }
+        graph.targets.resize(E);
+        graph.weights.resize(E);
+        std::vector<int> next(graph.start.begin(), graph.start.end() - 1);
+        for (int e = 0; e < E; e++) {
+            const int k = next[from[e]]++;
+            graph.targets[k] = e < V ? (e + 1) % V : rand() % V;
+            graph.weights[k] = 1 + rand() % 3600;
+        }
+    }
+
+    // Dijkstra with any heap of (distance, vertex) supporting push, top and pop,
+    // vertices are pushed again when their distance drops and the stale entries are skipped
+    template <typename Heap>
+    void dijkstraLazy(const WeightedGraph& graph, std::vector<unsigned>& dist, Heap& heap)
+    {
+        const int V = (int)graph.start.size() - 1;
+        dist.assign(V, UINT_MAX);
+        dist[0] = 0;
+        heap.push(std::make_pair(0u, 0));
+        while (!heap.empty()) {
+            const std::pair<unsigned, int> entry = heap.top();
+            heap.pop();
+            const int u = entry.second;
+            if (entry.first != dist[u]) {
+                continue;
+            }
+            for (int k = graph.start[u]; k < graph.start[u + 1]; k++) {
+                const int v = graph.targets[k];
+                const unsigned d = dist[u] + graph.weights[k];
+                if (d < dist[v]) {
+                    dist[v] = d;
+                    heap.push(std::make_pair(d, v));
+                }
+            }
+        }
+    }
+
+    void dijkstraIndexed(const WeightedGraph& graph, std::vector<unsigned>& dist)
+    {
+        const int V = (int)graph.start.size() - 1;
+        dist.assign(V, UINT_MAX);
+        heaps::IndexedHeap<unsigned, 2> heap(V);
+        dist[0] = 0;
+        heap.push(0, 0);
+        while (!heap.empty()) {
+            const int u = heap.pop_min();
+            for (int k = graph.start[u]; k < graph.start[u + 1]; k++) {
+                const int v = graph.targets[k];
+                const unsigned d = dist[u] + graph.weights[k];
+                if (d < dist[v]) {
+                    dist[v] = d;
+                    heap.push_or_decrease(v, d);
+                }
+            }
+        }
+    }
+
+    void dijkstraRadix(const WeightedGraph& graph, std::vector<unsigned>& dist)
+    {
+        const int V = (int)graph.start.size() - 1;
+        dist.assign(V, UINT_MAX);
+        heaps::RadixHeap<int> heap;
+        dist[0] = 0;
+        heap.push(0, 0);
+        while (!heap.empty()) {
+            const unsigned key = heap.top_key();
+            const int u = heap.top();
+            heap.pop();
+            if (key != dist[u]) {
+                continue;
+            }
+            for (int k = graph.start[u]; k < graph.start[u + 1]; k++) {
+                const int v = graph.targets[k];
+                const unsigned d = dist[u] + graph.weights[k];
+                if (d < dist[v]) {
+                    dist[v] = d;
+                    heap.push(d, v);
+                }
+            }
+        }
+    }
+
+    TEST_CASE("Dijkstra with every heap")
+    {
+        WeightedGraph graph;
+        generateGraph(graph, 3000, 12000);
+        std::vector<unsigned> expected, dist;
+        std::priority_queue<std::pair<unsigned, int>, std::vector<std::pair<unsigned, int>>,
+                            std::greater<std::pair<unsigned, int>>> stdHeap;
+        dijkstraLazy(graph, expected, stdHeap);
+        heaps::DaryHeap<std::pair<unsigned, int>, 2, std::greater<std::pair<unsigned, int>>> binary;
+        dijkstraLazy(graph, dist, binary);
+        REQUIRE( dist == expected );
+        dijkstraIndexed(graph, dist);
+        REQUIRE( dist == expected );
+        dijkstraRadix(graph, dist);
+        REQUIRE( dist == expected );
+    }
+
+    void benchmarkDijkstra(Profiler& profiler, int maxVertices)
+    {
+        printf("Dijkstra on random graphs with 4 edges per vertex, weights 1 ... 3600\n");
+        WeightedGraph graph;
+        std::vector<unsigned> expected, dist;
+        for (int V = 100000; V <= maxVertices; V += V < 1000000 ? 100000 : 1000000) {
+            printf("V(%d)\n", V);
+            generateGraph(graph, V, 4 * V);
+
+            profiler.startTimer("dijkstra_std", V);
+            {
+                std::priority_queue<std::pair<unsigned, int>, std::vector<std::pair<unsigned, int>>,
+                                    std::greater<std::pair<unsigned, int>>> heap;
+                dijkstraLazy(graph, expected, heap);
+            }
+            profiler.stopTimer("dijkstra_std", V);
+
+            profiler.startTimer("dijkstra_binary", V);
+            {
+                heaps::DaryHeap<std::pair<unsigned, int>, 2, std::greater<std::pair<unsigned, int>>> heap;
+                dijkstraLazy(graph, dist, heap);
+            }
+            profiler.stopTimer("dijkstra_binary", V);
+
+            profiler.startTimer("dijkstra_indexed", V);
+            dijkstraIndexed(graph, dist);
+            profiler.stopTimer("dijkstra_indexed", V);
+
+            profiler.startTimer("dijkstra_radix", V);
+            dijkstraRadix(graph, dist);
+            profiler.stopTimer("dijkstra_radix", V);
+
+            if (dist != expected) {
+                printf("the radix heap found different distances!\n");
+            }
+        }
+        profiler.createGroup("Dijkstra", "dijkstra_std", "dijkstra_binary", "dijkstra_indexed", "dijkstra_radix");
+        profiler.showReport();
+    }
+
+    // the double-ended queue made of two heaps: every value is in both, with an id, and a value popped from one of
+    // them is marked dead and skipped when it reaches the top of the other one
+    class PairedHeaps
+    {
+    public:
+        PairedHeaps() : count(0) {}
+
+        std::size_t size() const { return count; }
+
+        void push(int value)
+        {
+            const std::pair<int, int> entry(value, (int)alive.size());
+            alive.push_back(true);
+            minHeap.push_back(entry);
+            std::push_heap(minHeap.begin(), minHeap.end(), std::greater<std::pair<int, int>>());
+            maxHeap.push_back(entry);
+            std::push_heap(maxHeap.begin(), maxHeap.end());
+            count++;
+        }
+
+        int min()
+        {
+            skipDead(minHeap, std::greater<std::pair<int, int>>());
+            return minHeap.front().first;
+        }
+
+        int max()
+        {
+            skipDead(maxHeap, std::less<std::pair<int, int>>());
+            return maxHeap.front().first;
+        }
+
+        void pop_min()
+        {
+            popFrom(minHeap, maxHeap, std::greater<std::pair<int, int>>(), std::less<std::pair<int, int>>());
+        }
+
+        void pop_max()
+        {
+            popFrom(maxHeap, minHeap, std::less<std::pair<int, int>>(), std::greater<std::pair<int, int>>());
+        }
+
+    private:
+        template <typename Compare>
+        void skipDead(std::vector<std::pair<int, int>>& heap, Compare comp)
+        {
+            while (!alive[heap.front().second]) {
+                std::pop_heap(heap.begin(), heap.end(), comp);
+                heap.pop_back();
+            }
+        }
+
+        template <typename Compare, typename OtherCompare>
+        void popFrom(std::vector<std::pair<int, int>>& heap, std::vector<std::pair<int, int>>& other,
+                     Compare comp, OtherCompare otherComp)
+        {
+            skipDead(heap, comp);
+            alive[heap.front().second] = false;
+            std::pop_heap(heap.begin(), heap.end(), comp);
+            heap.pop_back();
+            count--;
+            // the dead values would pile up in the other heap if they never reach its top
+            if (other.size() > 2 * count + 16) {
+                std::vector<std::pair<int, int>> kept;
+                kept.reserve(count);
+                for (const std::pair<int, int>& entry : other) {
+                    if (alive[entry.second]) {
+                        kept.push_back(entry);
+                    }
+                }
+                other.swap(kept);
+                std::make_heap(other.begin(), other.end(), otherComp);
+            }
+        }
+
+        std::vector<std::pair<int, int>> minHeap, maxHeap;
+        std::vector<bool> alive;
+        std::size_t count;
+    };
+
+    // the best N of the stream, the sum of the best values read after every step is returned to compare the queues
+    long long bestMinMax(const std::vector<int>& stream, int N)
+    {
+        heaps::MinMaxHeap<int> heap(N);
+        long long sum = 0;
+        for (int value : stream) {
+            heap.push(value);
+            sum += heap.min();
+        }
+        return sum;
+    }
+
+    long long bestPaired(const std::vector<int>& stream, int N)
+    {
+        PairedHeaps heaps;
+        long long sum = 0;
+        for (int value : stream) {
+            if ((int)heaps.size() < N) {
+                heaps.push(value);
+            } else if (value < heaps.max()) {
+                heaps.pop_max();
+                heaps.push(value);
+            }
+            sum += heaps.min();
+        }
+        return sum;
+    }
+
+    long long bestMultiset(const std::vector<int>& stream, int N)
+    {
+        std::multiset<int> set;
+        long long sum = 0;
+        for (int value : stream) {
+            if ((int)set.size() < N) {
+                set.insert(value);
+            } else if (value < *set.rbegin()) {
+                set.erase(std::prev(set.end()));
+                set.insert(value);
+            }
+            sum += *set.begin();
+        }
+        return sum;
+    }
+
+    void benchmarkMinMaxHeap(Profiler& profiler, int n)
+    {
+        std::vector<int> stream(n);
+        FillRandomArray(stream.data(), n, 0, 1000000000);
+        for (int N = 10; N <= 1000000 && N <= n; N *= 10) {
+            printf("best N(%d)\n", N);
+            profiler.startTimer("best_minmax", N);
+            const long long expected = bestMinMax(stream, N);
+            profiler.stopTimer("best_minmax", N);
+
+            profiler.startTimer("best_paired", N);
+            const long long paired = bestPaired(stream, N);
+            profiler.stopTimer("best_paired", N);
+
+            profiler.startTimer("best_multiset", N);
+            const long long multiset = bestMultiset(stream, N);
+            profiler.stopTimer("best_multiset", N);
+
+            if (paired != expected || multiset != expected) {
+                printf("the queues kept different values!\n");
+            }
+        }
+
+        for (int size = 100000; size <= 1000000 && size <= n; size += 100000) {
+            printf("drain(%d)\n", size);
+            long long expected = 0, sum = 0;
+
+            profiler.startTimer("drain_minmax", size);
+            {
+                heaps::MinMaxHeap<int> heap(stream.begin(), stream.begin() + size);
+                while (!heap.empty()) {
+                    expected += heap.max();
+                    heap.pop_max();
+                    if (!heap.empty()) {
+                        expected -= heap.min();
+                        heap.pop_min();
+                    }
+                }
+            }
+            profiler.stopTimer("drain_minmax", size);
+
+            profiler.startTimer("drain_paired", size);
+            {
+                PairedHeaps heaps;
+                for (int i = 0; i < size; i++) {
+                    heaps.push(stream[i]);
+                }
+                while (heaps.size() > 0) {
+                    sum += heaps.max();
+                    heaps.pop_max();
+                    if (heaps.size() > 0) {
+                        sum -= heaps.min();
+                        heaps.pop_min();
+                    }
+                }
+            }
+            profiler.stopTimer("drain_paired", size);
+
+            profiler.startTimer("drain_multiset", size);
+            {
+                std::multiset<int> set(stream.begin(), stream.begin() + size);
+                while (!set.empty()) {
+                    sum += *set.rbegin();
+                    set.erase(std::prev(set.end()));
+                    if (!set.empty()) {
+                        sum -= *set.begin();
+                        set.erase(set.begin());
+                    }
+                }
+            }
+            profiler.stopTimer("drain_multiset", size);
+
+            if (sum != 2 * expected) {
+                printf("the queues were drained in different orders!\n");
+            }
+        }
+        profiler.createGroup("Best N of the stream", "best_minmax", "best_paired", "best_multiset");
+        profiler.createGroup("Drain from both ends", "drain_minmax", "drain_paired", "drain_multiset");
+        profiler.showReport();
+    }
+
+} // namespace lab02
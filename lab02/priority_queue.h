@@ -0,0 +1,44 @@
+#ifndef __PRIORITY_QUEUE_H__
+#define __PRIORITY_QUEUE_H__
+
+#include "Profiler.h"
+#include "commandline.h"
+
+namespace lab02
+{
+
+    /**
+     * @brief Benchmark of the d-ary heaps against std::priority_queue and the heap sort of this laboratory
+     *
+     * Every heap is built from n random values and drained, then filled by n pushes and drained again.
+     *
+     * @param profiler profiler to use
+     * @param maxSize largest number of elements, the sizes go from 10^6 up to it
+     */
+    void benchmarkPriorityQueues(Profiler& profiler, int maxSize);
+
+    /**
+     * @brief Benchmark of Dijkstra's algorithm on random graphs with the weights of lab08 (1 ... 3600)
+     *
+     * Compares std::priority_queue, the binary d-ary heap (both with lazy deletion), the indexed heap with
+     * decrease-key and the radix heap.
+     *
+     * @param profiler profiler to use
+     * @param maxVertices largest number of vertices, the sizes go from 10^5 up to it
+     */
+    void benchmarkDijkstra(Profiler& profiler, int maxVertices);
+
+    /**
+     * @brief Benchmark of the min-max heap against a pair of heaps (min and max) and std::multiset
+     *
+     * The best (smallest) N values of a random stream are kept while the best one is read after every value, then
+     * heaps of up to 10^6 values are drained by popping the minimum and the maximum in turn.
+     *
+     * @param profiler profiler to use
+     * @param n length of the stream
+     */
+    void benchmarkMinMaxHeap(Profiler& profiler, int n);
+
+} // namespace lab02
+
+#endif // __PRIORITY_QUEUE_H__
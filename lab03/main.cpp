@@ -1,4 +1,10 @@
 #include "quick_sort.h"
+#include "parallel_sort.h"
+#include "radix_sort.h"
+#include "segmented_sort.h"
+#include "selection.h"
+#include "threshold_tuning.h"
+#include "top_k.h"
 
 #define CATCH_CONFIG_RUNNER
 #include "catch2.hpp"
@@ -39,6 +45,71 @@ void bench(const CommandArgs& args)
     profiler.reset();
 }
 
+void benchParallel(const CommandArgs& args)
+{
+    const int n = args.empty()? 10000000: atoi(args[0]);
+    const int maxThreads = args.size() < 2? 0: atoi(args[1]);
+    benchmarkParallel(profiler, n, maxThreads);
+    profiler.reset();
+}
+
+void benchPartitions(const CommandArgs& args)
+{
+    benchmarkPartitions(profiler);
+    profiler.reset();
+}
+
+void benchDuplicates(const CommandArgs& args)
+{
+    benchmarkDuplicates(profiler);
+    profiler.reset();
+}
+
+void benchRecords(const CommandArgs& args)
+{
+    benchmarkRecords(profiler);
+    profiler.reset();
+}
+
+void benchRadix(const CommandArgs& args)
+{
+    const int maxSize = args.empty()? 100000000: atoi(args[0]);
+    benchmarkRadix(profiler, maxSize);
+    profiler.reset();
+}
+
+void benchSelection(const CommandArgs& args)
+{
+    benchmarkSelection(profiler);
+    profiler.reset();
+}
+
+void benchMultiSelect(const CommandArgs& args)
+{
+    benchmarkMultiSelect(profiler);
+    profiler.reset();
+}
+
+void benchSegments(const CommandArgs& args)
+{
+    benchmarkSegments(profiler);
+    profiler.reset();
+}
+
+void benchTopK(const CommandArgs& args)
+{
+    const int n = args.empty()? 10000000: atoi(args[0]);
+    benchmarkTopK(profiler, n);
+    profiler.reset();
+}
+
+void tune(const CommandArgs& args)
+{
+    const int n = args.empty()? 1 << 16: atoi(args[0]);
+    tuneHybridThreshold(profiler, n);
+    profiler.reset();
+}
+
 int main()
 {
     const std::vector<CommandSpec> commands =
@@ -47,6 +118,16 @@ int main()
         {"test", test, "run unit-tests"},
         {"perf", perf, "[avg(default)|best|worst] - run performance analysis on selected case"},
         {"bench", bench, "[avg(default)|best|worst] - run benchmarks on selected case"},
+        {"bench_parallel", benchParallel, "[n(default 10^7)] [max threads(default all)] - run scaling benchmarks of parallel quick sort"},
+        {"bench_partition", benchPartitions, "run benchmarks of the partitioning schemes on random inputs"},
+        {"bench_dup", benchDuplicates, "run benchmarks of Lomuto vs three-way partitioning on few distinct values"},
+        {"bench_records", benchRecords, "run benchmarks of direct vs indirect sorting on large records"},
+        {"bench_radix", benchRadix, "[max n(default 10^8)] - run benchmarks of the radix sorts against quick sort"},
+        {"bench_select", benchSelection, "run benchmarks of the selection algorithms against std::nth_element"},
+        {"bench_multiselect", benchMultiSelect, "run benchmarks of multi-select on percentiles and of partial sort"},
+        {"bench_segments", benchSegments, "run throughput benchmarks of sorting many small segments"},
+        {"bench_topk", benchTopK, "[n(default 10^7)] - run throughput benchmarks of streaming top-k selection"},
+        {"tune", tune, "[n(default 2^16)] - find the fastest hybrid quick sort threshold on this CPU and save it"},
     };
     return runCommandLoop(commands);
 }
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef __PARALLEL_SORT_H__
+#define __PARALLEL_SORT_H__
+
+#include "Profiler.h"
+#include "commandline.h"
+#include "threshold_tuning.h"
+
+namespace lab03
+{
+
+	/**
+	 * @brief Ranges up to this size are sorted serially by the thread that owns them
+	 */
+	constexpr int PARALLEL_TASK_CUTOFF = 1 << 15;
+
+	/**
+	 * @brief Ranges from this size up are partitioned by all the threads together
+	 */
+	constexpr int PARALLEL_PARTITION_SIZE = 1 << 20;
+
+	/**
+	 * @brief Quick sort on several threads
+	 *
+	 * Near the root, where a serial partition would leave every other thread waiting, the largest ranges are
+	 * partitioned by all the threads together until there is a range per thread. Each thread then keeps
+	 * partitioning its ranges (block partitioning around the median of 3 / ninther), works on the larger side and
+	 * pushes the smaller one onto its own deque, from which idle threads steal the oldest (largest) ranges.
+	 * Ranges up to PARALLEL_TASK_CUTOFF are finished by introSort, insertion sort leaf included.
+	 *
+	 * @param values array of input values to be sorted
+	 * @param n number of values in the input array
+	 * @param threads number of threads, 0 uses every hardware thread
+	 * @param threshold largest range sorted by insertion sort, TUNED_THRESHOLD for hybridThreshold()
+	 */
+	void parallelQuickSort(int* values, int n, int threads = 0, int threshold = TUNED_THRESHOLD);
+
+	/**
+	 * @brief Scaling benchmark of parallelQuickSort from 1 to maxThreads threads
+	 *
+	 * @param profiler profiler to use
+	 * @param n number of values to sort
+	 * @param maxThreads largest number of threads, 0 for the number of hardware threads
+	 */
+	void benchmarkParallel(Profiler& profiler, int n, int maxThreads);
+
+} // namespace lab03
+
+#endif // __PARALLEL_SORT_H__
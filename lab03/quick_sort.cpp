@@ -1,8 +1,19 @@
 #include "quick_sort.h"
 
 #include "catch2.hpp"
+#include "cpu_features.h"
+#include "sorting.h"
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#   include <pthread.h>
+#endif
 
 /*
  * ---------- AVG CASE ----------
@@ -41,6 +52,7 @@
  * arrow". The data is really noisy due to the os conditions imposing unpredictability on the runtime.
  * , therefore we pick the most promising interval from 25 to 45 and run another pass with much more resolution
  * to even out the data. As it seems, the optimal threshold value is 33, confirmed by the graphs.
+ * The best value depends on the machine, the tune command searches for it again and stores it (see threshold_tuning.cpp).
  *
  * ---------- QSORT vs Hybrid QSORT ----------
  * For a really small amount of elements (up to 33), hybrid quicksort performs better than regular qsort, it especially excels in big arrays.
@@ -51,6 +63,62 @@
  * Quick select is a simple algorithm that uses the same partition function to find the k-th smallest element in an array.
  * It is basically a partial quicksort that only sorts the corresponding partitions that the smallest element we are looking for will be in.
  * This yields an O(n) complexity and is quite a good algorithm for finding k-th smallest elements in an unordered array.
+ *
+ * ---------- INTROSORT ----------
+ * The last element pivot turns sorted, reverse sorted and constant inputs into partitions of size 0 and n - 1, so
+ * quick sort is O(n^2) and recurses n levels deep, which overflows the stack at ~10^5-10^6 elements. Introsort picks
+ * the median of 3 (the ninther above 128 elements) as the pivot, which makes sorted inputs the best case instead of
+ * the worst, and counts the recursion depth: past 2 * log2(n) levels the range is given to heap sort, so no input
+ * can make it O(n^2) or deeper than 2 * log2(n). Ranges of up to 29 elements still go to insertion sort.
+ * On the descending 10^4 array hybrid quick sort does 46M comparisons, introsort 179K. On random arrays the median
+ * makes the partitions more even and introsort needs ~15% fewer comparisons than hybrid quick sort, and it runs as
+ * fast on 10^6 random ints (~125 ms, heap sort ~250 ms). 10^6 ascending / descending ints take 28 / 55 ms, where
+ * hybrid quick sort crashed (see BOUNDED STACK, now it only takes quadratic time).
+ *
+ * ---------- THREE-WAY PARTITIONING ----------
+ * Lomuto sends the elements equal to the pivot to the left side, so a value repeated m times is split off one
+ * element per partition and every run of equal keys costs O(m^2): with 20 distinct values among n the sort becomes
+ * ~n^2/40 comparisons. The Bentley-McIlroy partition (THREE_WAY) scans from both ends and parks the elements equal
+ * to the pivot at the two ends of the range. At the end it swaps them next to the pivot, and the whole block of
+ * equal keys is left out of the recursion. With 20 distinct values the recursion is at most ~20 levels deep and
+ * the sort is linear: 10^5 elements take 3-4 ms instead of ~750 ms for quickSort and hybridizedQuickSort, and an
+ * all equal array takes a single pass. quickSelect gains the same way (2 ms against up to 39 ms, depending on how
+ * many copies of the pivots land on the searched side). On distinct random values both schemes are within the
+ * noise of each other (~130-160 ms for 10^6 ints): the two sided scan does fewer swaps, but pays for the equality
+ * checks.
+ *
+ * ---------- BLOCK PARTITIONING ----------
+ * On random data the `values[j] <= pivot` branch of Lomuto is taken half of the time in no predictable pattern, so
+ * about every second element costs a pipeline flush. The BLOCK partition compares 128 elements from each end and
+ * writes the offset of every element unconditionally, advancing the write position by the result of the
+ * comparison. That is an add instead of a branch, and the loop runs the same way whatever the data. The misplaced
+ * elements of the two blocks are then swapped pairwise. The comparisons and moves are the same as for Hoare's
+ * partition, only the mispredictions are gone. Random ints, 5 runs: hybrid quick sort of 10^6 elements 846 ms with
+ * Lomuto, 849 ms three-way and 538 ms with blocks (-37%). Quick select of the median drops from ~100 ms to ~35 ms,
+ * since it is nothing but partitions.
+ *
+ * ---------- BOUNDED STACK ----------
+ * quickSort and hybridizedQuickSort recurse only on the smaller side of a partition and loop on the larger one.
+ * The smaller side has at most half of the elements, so there are at most log2(n) nested calls whatever the
+ * pivots (~27 frames for 10^8 elements), and quickSelect only ever continues on one side, so it is a plain loop.
+ * A sorted input is still O(n^2) with the last element pivot, but it no longer crashes: sorting 10^4 ascending
+ * ints on a thread with a 64 KiB stack overflowed it before and works now. The partitions are exactly the ones
+ * of the recursive version, so the operation counts are unchanged, and the times on random inputs are within the
+ * noise (bench_partition, sum over all sizes: 4.35-4.51 s before, 4.53-4.56 s after for Lomuto, 2.79 s for block
+ * partitions in both).
+ *
+ * ---------- VECTOR PARTITIONING ----------
+ * The VECTOR partition does the comparisons of BLOCK 8 at a time: one compare and one movemask give a byte with a
+ * bit per element going right, and a 256 entry table of permutations packs the 8 elements so that the ones going
+ * left come first. The packed vector is stored whole at both write positions and each side keeps only its part,
+ * so there is no branch and no swap per element, every element is loaded and stored once. Two vectors are held
+ * back at the start to leave room on both sides, and the remaining tail (< 8) is finished by a scalar loop. The
+ * kernel is chosen on the first call: AVX2 (8 lanes), SSE4.1 with a byte shuffle table (4 lanes), otherwise BLOCK.
+ * Equal elements go left from one vector and right from the next, so an all-equal input still splits in half
+ * (10^5 equal ints, 1.5*10^6 comparisons instead of ~5*10^9). bench_partition on AVX2, sum over all sizes:
+ * hybrid quick sort 1.53-1.77 s against 2.18-2.56 s for BLOCK and 3.8-4.0 s for Lomuto (-30% from BLOCK),
+ * quick select of the median 97-102 ms against 180-224 ms for BLOCK. The leaves below the insertion sort
+ * threshold and the ranges under 64 elements are the same code as before, which is most of what is left.
  */
 
 namespace lab03
@@ -74,20 +142,343 @@ namespace lab03
         return i;
     }
 
-    void qsort(int* values, int l, int r, Operation* opAsg, Operation* opCmp) {
+    // Bentley-McIlroy three-way partition around values[r]: afterwards values[l, lt) are smaller than the pivot,
+    // values[lt, gt] equal to it and values(gt, r] greater
+    void partition3(int* values, const int l, const int r, int& lt, int& gt, Operation* opAsg, Operation* opCmp) {
         if (l >= r) {
+            lt = gt = r;
             return;
         }
+        const int pivot = values[r];
+        if (opAsg) opAsg->count();
+        // the equal elements found by the scans are parked at both ends: values[l, p] and values[q, r)
+        int i = l - 1, j = r, p = l - 1, q = r;
+        for (;;) {
+            while (true) {
+                ++i;
+                if (opCmp) opCmp->count();
+                if (!(values[i] < pivot)) break;
+            }
+            while (true) {
+                --j;
+                if (opCmp) opCmp->count();
+                if (!(pivot < values[j]) || j == l) break;
+            }
+            if (i >= j) {
+                break;
+            }
+            std::swap(values[i], values[j]);
+            if (opAsg) opAsg->count(3);
+            if (opCmp) opCmp->count();
+            if (values[i] == pivot) {
+                p++;
+                std::swap(values[p], values[i]);
+                if (opAsg) opAsg->count(3);
+            }
+            if (opCmp) opCmp->count();
+            if (values[j] == pivot) {
+                q--;
+                std::swap(values[q], values[j]);
+                if (opAsg) opAsg->count(3);
+            }
+        }
+        std::swap(values[i], values[r]);
+        if (opAsg) opAsg->count(3);
 
-        const int pivot = partition(values, l, r, opAsg, opCmp);
+        // the parked equal elements are swapped in next to the pivot
+        j = i - 1;
+        i = i + 1;
+        for (int k = l; k <= p; k++, j--) {
+            std::swap(values[k], values[j]);
+            if (opAsg) opAsg->count(3);
+        }
+        for (int k = r - 1; k >= q; k--, i++) {
+            std::swap(values[k], values[i]);
+            if (opAsg) opAsg->count(3);
+        }
+        lt = j + 1;
+        gt = i - 1;
+    }
 
-        qsort(values, l, pivot - 1, opAsg, opCmp);
-        qsort(values, pivot + 1, r, opAsg, opCmp);
+    // BlockQuicksort partition around values[r], returns the final position of the pivot
+    int partitionBlock(int* values, const int l, const int r, Operation* opAsg, Operation* opCmp) {
+        if (l >= r) {
+            return r;
+        }
+        const int pivot = values[r];
+        if (opAsg) opAsg->count();
+        unsigned char offsetsL[PARTITION_BLOCK], offsetsR[PARTITION_BLOCK];
+        int numL = 0, numR = 0, startL = 0, startR = 0;
+        // values[l, L) are not greater than the pivot, values(R, r) not smaller, the rest is still unknown
+        int L = l, R = r - 1;
+        while (R - L + 1 >= 2 * PARTITION_BLOCK) {
+            if (numL == 0) {
+                // the offsets of the elements that belong to the right side, written every time and kept
+                // only when the comparison says so: no branch depends on the data
+                startL = 0;
+                for (int i = 0; i < PARTITION_BLOCK; i++) {
+                    offsetsL[numL] = (unsigned char)i;
+                    numL += !(values[L + i] < pivot);
+                }
+                if (opCmp) opCmp->count(PARTITION_BLOCK);
+            }
+            if (numR == 0) {
+                startR = 0;
+                for (int i = 0; i < PARTITION_BLOCK; i++) {
+                    offsetsR[numR] = (unsigned char)i;
+                    numR += !(pivot < values[R - i]);
+                }
+                if (opCmp) opCmp->count(PARTITION_BLOCK);
+            }
+            const int num = numL < numR ? numL : numR;
+            for (int k = 0; k < num; k++) {
+                std::swap(values[L + offsetsL[startL + k]], values[R - offsetsR[startR + k]]);
+            }
+            if (opAsg) opAsg->count(3 * num);
+            numL -= num;
+            numR -= num;
+            startL += num;
+            startR += num;
+            if (numL == 0) {
+                L += PARTITION_BLOCK;
+            }
+            if (numR == 0) {
+                R -= PARTITION_BLOCK;
+            }
+        }
+
+        // fewer than two blocks are left (with the one that still has misplaced elements, if any),
+        // they are finished by scanning from both ends
+        for (;;) {
+            while (L <= R) {
+                if (opCmp) opCmp->count();
+                if (!(values[L] < pivot)) break;
+                L++;
+            }
+            while (L <= R) {
+                if (opCmp) opCmp->count();
+                if (!(pivot < values[R])) break;
+                R--;
+            }
+            if (L >= R) {
+                break;
+            }
+            std::swap(values[L], values[R]);
+            if (opAsg) opAsg->count(3);
+            L++;
+            R--;
+        }
+        std::swap(values[L], values[r]);
+        if (opAsg) opAsg->count(3);
+        return L;
+    }
+
+    enum VectorKernel { KERNEL_BLOCK, KERNEL_SSE, KERNEL_AVX2 };
+
+    // the widest kernel the CPU running the program supports
+    VectorKernel vectorKernel() {
+        static const VectorKernel kernel = cpuSupportsAvx2() ? KERNEL_AVX2
+                                         : cpuSupportsSse41() ? KERNEL_SSE : KERNEL_BLOCK;
+        return kernel;
     }
 
-    void quickSort(int* values, int n, Operation* opAsg, Operation* opCmp)
+#ifdef HAS_X86_SIMD
+    // for every comparison mask (bit i set: lane i goes right) the permutation that moves the lanes going left to
+    // the front in their order, the ones going right after them, and the number of lanes going right
+    struct PartitionTables {
+        alignas(32) int avx2[256][8];
+        alignas(16) unsigned char sse[16][16];
+        unsigned char right[256];
+
+        PartitionTables() {
+            for (int mask = 0; mask < 256; mask++) {
+                int k = 0;
+                for (int side = 0; side < 2; side++) {
+                    for (int i = 0; i < 8; i++) {
+                        if (((mask >> i) & 1) == side) {
+                            avx2[mask][k++] = i;
+                        }
+                    }
+                }
+                right[mask] = 0;
+                for (int i = 0; i < 8; i++) {
+                    right[mask] += (mask >> i) & 1;
+                }
+            }
+            for (int mask = 0; mask < 16; mask++) {
+                int k = 0;
+                for (int side = 0; side < 2; side++) {
+                    for (int i = 0; i < 4; i++) {
+                        if (((mask >> i) & 1) == side) {
+                            for (int b = 0; b < 4; b++) {
+                                sse[mask][4 * k + b] = (unsigned char)(4 * i + b);
+                            }
+                            k++;
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    const PartitionTables& partitionTables() {
+        static const PartitionTables tables; // initialization is thread safe
+        return tables;
+    }
+
+    // the < 8 values of the middle that were never loaded into a vector and the two vectors loaded first fill the
+    // space left between the two sides exactly; the values equal to the pivot are spread over both sides
+    int finishVectorPartition(int* values, const int r, int writeL, int writeR, const int* rest, const int count) {
+        const int pivot = values[r];
+        bool equalLeft = true;
+        for (int i = 0; i < count; i++) {
+            const int x = rest[i];
+            if (x < pivot || (x == pivot && equalLeft)) {
+                values[writeL++] = x;
+            } else {
+                values[--writeR] = x;
+            }
+            if (x == pivot) {
+                equalLeft = !equalLeft;
+            }
+        }
+        std::swap(values[writeL], values[r]);
+        return writeL;
+    }
+
+    // vectorized partition of values[l..r] around values[r], r - l >= 16: the values are compared 8 at a time, and
+    // each vector is permuted so that its left-going lanes come first and stored whole on both sides, of which
+    // only the part that belongs there is kept. The first vector of each end is held in a register, which leaves
+    // 8 free places on each side, and the next vector is read from the side with less free space, so both sides
+    // always have room for a whole vector
+    TARGET_AVX2 int partitionAvx2(int* values, const int l, const int r, const PartitionTables& tables) {
+        const __m256i pivot = _mm256_set1_epi32(values[r]);
+        const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + l));
+        const __m256i last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + r - 8));
+        // values[l, writeL) are not greater than the pivot, values[writeR, r) not smaller, [readL, readR) unread
+        int readL = l + 8, readR = r - 8, writeL = l, writeR = r;
+        // the values equal to the pivot go left from one vector and right from the next one
+        int equalRight = 0;
+        while (readR - readL >= 8) {
+            __m256i v;
+            if (readL - writeL <= writeR - readR) {
+                v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + readL));
+                readL += 8;
+            } else {
+                readR -= 8;
+                v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + readR));
+            }
+            const int greater = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, pivot)));
+            const int notLess = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivot, v))) & 0xFF;
+            const int right = greater | (notLess & equalRight);
+            equalRight ^= 0xFF;
+            const __m256i order = _mm256_load_si256(reinterpret_cast<const __m256i*>(tables.avx2[right]));
+            const __m256i permuted = _mm256_permutevar8x32_epi32(v, order);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + writeL), permuted);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + writeR - 8), permuted);
+            writeL += 8 - tables.right[right];
+            writeR -= tables.right[right];
+        }
+
+        int rest[24];
+        const int middle = readR - readL;
+        std::copy(values + readL, values + readR, rest);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rest + middle), first);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rest + middle + 8), last);
+        return finishVectorPartition(values, r, writeL, writeR, rest, middle + 16);
+    }
+
+    // partitionAvx2 with 4 lanes, for the CPUs without AVX2
+    TARGET_SSE41 int partitionSse(int* values, const int l, const int r, const PartitionTables& tables) {
+        const __m128i pivot = _mm_set1_epi32(values[r]);
+        const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + l));
+        const __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + r - 4));
+        int readL = l + 4, readR = r - 4, writeL = l, writeR = r;
+        int equalRight = 0;
+        while (readR - readL >= 4) {
+            __m128i v;
+            if (readL - writeL <= writeR - readR) {
+                v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + readL));
+                readL += 4;
+            } else {
+                readR -= 4;
+                v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + readR));
+            }
+            const int greater = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, pivot)));
+            const int notLess = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(pivot, v))) & 0xF;
+            const int right = greater | (notLess & equalRight);
+            equalRight ^= 0xF;
+            const __m128i order = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.sse[right]));
+            const __m128i permuted = _mm_shuffle_epi8(v, order);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(values + writeL), permuted);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(values + writeR - 4), permuted);
+            writeL += 4 - tables.right[right];
+            writeR -= tables.right[right];
+        }
+
+        int rest[12];
+        const int middle = readR - readL;
+        std::copy(values + readL, values + readR, rest);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rest + middle), first);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rest + middle + 4), last);
+        return finishVectorPartition(values, r, writeL, writeR, rest, middle + 8);
+    }
+#endif
+
+    // VECTOR partition around values[r] with the given kernel, returns the final position of the pivot;
+    // small ranges and CPUs without SSE4.1 use the BLOCK partition
+    int partitionVector(int* values, const int l, const int r, const VectorKernel kernel, Operation* opAsg,
+                        Operation* opCmp) {
+        if (r - l < PARTITION_VECTOR_MIN || kernel == KERNEL_BLOCK) {
+            return partitionBlock(values, l, r, opAsg, opCmp);
+        }
+        // every value is compared once and written once, plus the swap of the pivot
+        if (opCmp) opCmp->count(r - l);
+        if (opAsg) opAsg->count(r - l + 3);
+#ifdef HAS_X86_SIMD
+        const PartitionTables& tables = partitionTables();
+        if (kernel == KERNEL_AVX2) {
+            return partitionAvx2(values, l, r, tables);
+        }
+        return partitionSse(values, l, r, tables);
+#else
+        return partitionBlock(values, l, r, nullptr, nullptr);
+#endif
+    }
+
+    // partitions values[l..r] with the given scheme, values[lt..gt] are then in their final place
+    void partitionRange(int* values, const int l, const int r, int& lt, int& gt, const PartitionScheme scheme,
+                        Operation* opAsg, Operation* opCmp) {
+        if (scheme == THREE_WAY) {
+            partition3(values, l, r, lt, gt, opAsg, opCmp);
+        } else if (scheme == BLOCK) {
+            lt = gt = partitionBlock(values, l, r, opAsg, opCmp);
+        } else if (scheme == VECTOR) {
+            lt = gt = partitionVector(values, l, r, vectorKernel(), opAsg, opCmp);
+        } else {
+            lt = gt = partition(values, l, r, opAsg, opCmp);
+        }
+    }
+
+    // recurses on the smaller side and loops on the larger one, so the stack is at most log2(n) frames deep
+    void qsort(int* values, int l, int r, Operation* opAsg, Operation* opCmp, const PartitionScheme scheme) {
+        while (l < r) {
+            int lt, gt;
+            partitionRange(values, l, r, lt, gt, scheme, opAsg, opCmp);
+
+            if (lt - l < r - gt) {
+                qsort(values, l, lt - 1, opAsg, opCmp, scheme);
+                l = gt + 1;
+            } else {
+                qsort(values, gt + 1, r, opAsg, opCmp, scheme);
+                r = lt - 1;
+            }
+        }
+    }
+
+    void quickSort(int* values, int n, Operation* opAsg, Operation* opCmp, const PartitionScheme scheme)
     {
-        qsort(values, 0, n - 1, opAsg, opCmp);
+        qsort(values, 0, n - 1, opAsg, opCmp, scheme);
     }
 
     constexpr int left(const int i) {
@@ -177,45 +568,132 @@ namespace lab03
         }
     }
 
-    void hb_qsort(int* values, int l, int r, Operation* opAsg, Operation* opCmp, const int threshold) {
-        const int n = r - l + 1;
-
-        if (n <= threshold)
-            insertionSort(values + l, n, opAsg, opCmp);
-        else {
+    // same bounded stack as qsort, the range left when the loop ends goes to insertion sort
+    void hb_qsort(int* values, int l, int r, Operation* opAsg, Operation* opCmp, const int threshold,
+                  const PartitionScheme scheme) {
+        while (r - l + 1 > threshold) {
             if (l >= r) {
                 return;
             }
 
-            const int pivot = partition(values, l, r, opAsg, opCmp);
+            int lt, gt;
+            partitionRange(values, l, r, lt, gt, scheme, opAsg, opCmp);
 
-            hb_qsort(values, l, pivot - 1, opAsg, opCmp, threshold);
-            hb_qsort(values, pivot + 1, r, opAsg, opCmp, threshold);
+            if (lt - l < r - gt) {
+                hb_qsort(values, l, lt - 1, opAsg, opCmp, threshold, scheme);
+                l = gt + 1;
+            } else {
+                hb_qsort(values, gt + 1, r, opAsg, opCmp, threshold, scheme);
+                r = lt - 1;
+            }
         }
+        insertionSort(values + l, r - l + 1, opAsg, opCmp);
     }
 
-    void hybridizedQuickSort(int* values, int n, Operation* opAsg, Operation* opCmp, const int threshold)
+    void hybridizedQuickSort(int* values, int n, Operation* opAsg, Operation* opCmp, const int threshold,
+                             const PartitionScheme scheme)
     {
-        hb_qsort(values, 0, n - 1, opAsg, opCmp, threshold);
+        hb_qsort(values, 0, n - 1, opAsg, opCmp, threshold == TUNED_THRESHOLD ? hybridThreshold() : threshold, scheme);
     }
 
-    int q_select(int* values, int l, int r, int k, Operation* opAsg, Operation* opCmp)
+    // only the side holding k is searched, so the recursion is a loop and the stack does not grow
+    int q_select(int* values, int l, int r, int k, Operation* opAsg, Operation* opCmp, const PartitionScheme scheme)
     {
-        if (opAsg) opAsg->count();
-        const int p = partition(values, l, r, opAsg, opCmp);
-        if (p == k) {
-            if (opCmp) opCmp->count();
-            return values[k];
+        for (;;) {
+            if (opAsg) opAsg->count();
+            int lt, gt;
+            partitionRange(values, l, r, lt, gt, scheme, opAsg, opCmp);
+            if (lt <= k && k <= gt) {
+                if (opCmp) opCmp->count();
+                return values[k];
+            }
+            if (k < lt) {
+                if (opCmp) opCmp->count();
+                r = lt - 1;
+            } else {
+                l = gt + 1;
+            }
+        }
+    }
+
+    int quickSelect(int* values, int n, int k, Operation* opAsg, Operation* opCmp, const PartitionScheme scheme) {
+        return q_select(values, 0, n - 1, k, opAsg, opCmp, scheme);
+    }
+
+    // sorts values[a], values[b], values[c] so the median of the three ends up at b
+    void medianOf3(int* values, const int a, const int b, const int c, Operation* opAsg, Operation* opCmp) {
+        if (opCmp) opCmp->count();
+        if (values[b] < values[a]) {
+            std::swap(values[a], values[b]);
+            if (opAsg) opAsg->count(3);
         }
-        if (k < p) {
+        if (opCmp) opCmp->count();
+        if (values[c] < values[b]) {
+            std::swap(values[b], values[c]);
+            if (opAsg) opAsg->count(3);
             if (opCmp) opCmp->count();
-            return q_select(values, l, p - 1, k, opAsg, opCmp);
+            if (values[b] < values[a]) {
+                std::swap(values[a], values[b]);
+                if (opAsg) opAsg->count(3);
+            }
+        }
+    }
+
+    // moves the chosen pivot of values[l..r] to r, where partition takes it from
+    void choosePivot(int* values, const int l, const int r, Operation* opAsg, Operation* opCmp) {
+        const int n = r - l + 1;
+        const int mid = l + n / 2;
+        if (n > INTRO_NINTHER_SIZE) {
+            const int step = n / 8;
+            medianOf3(values, l, l + step, l + 2 * step, opAsg, opCmp);
+            medianOf3(values, mid - step, mid, mid + step, opAsg, opCmp);
+            medianOf3(values, r - 2 * step, r - step, r, opAsg, opCmp);
+            medianOf3(values, l + step, mid, r - step, opAsg, opCmp);
+        } else {
+            medianOf3(values, l, mid, r, opAsg, opCmp);
         }
-        return q_select(values, p + 1, r, k, opAsg, opCmp);
+        std::swap(values[mid], values[r]);
+        if (opAsg) opAsg->count(3);
     }
 
-    int quickSelect(int* values, int n, int k, Operation* opAsg, Operation* opCmp) {
-        return q_select(values, 0, n - 1, k, opAsg, opCmp);
+    void pivotPartition(int* values, const int l, const int r, int& lt, int& gt, const PartitionScheme scheme,
+                        Operation* opAsg, Operation* opCmp) {
+        choosePivot(values, l, r, opAsg, opCmp);
+        partitionRange(values, l, r, lt, gt, scheme, opAsg, opCmp);
+    }
+
+    void intro_sort(int* values, int l, int r, int depth, Operation* opAsg, Operation* opCmp, const int threshold,
+                    const PartitionScheme scheme) {
+        const int n = r - l + 1;
+        if (n <= 1) {
+            return;
+        }
+        if (n <= threshold) {
+            insertionSort(values + l, n, opAsg, opCmp);
+            return;
+        }
+        if (depth == 0) {
+            // the pivots keep failing on this range, heap sort is O(n log n) whatever the input
+            heapSort(values + l, n, opAsg, opCmp);
+            return;
+        }
+
+        int lt, gt;
+        pivotPartition(values, l, r, lt, gt, scheme, opAsg, opCmp);
+
+        intro_sort(values, l, lt - 1, depth - 1, opAsg, opCmp, threshold, scheme);
+        intro_sort(values, gt + 1, r, depth - 1, opAsg, opCmp, threshold, scheme);
+    }
+
+    void introSort(int* values, int n, Operation* opAsg, Operation* opCmp, const int threshold,
+                   const PartitionScheme scheme)
+    {
+        int log2n = 0;
+        while ((1 << (log2n + 1)) <= n && log2n < 30) {
+            log2n++;
+        }
+        intro_sort(values, 0, n - 1, 2 * log2n, opAsg, opCmp, threshold == TUNED_THRESHOLD ? hybridThreshold() : threshold,
+                   scheme);
     }
 
     void printArray(const int* values, const int n) {
@@ -247,6 +725,24 @@ namespace lab03
         printf("After heapsort: ");
         printArray(values_to_sort, size);
 
+        CopyArray(values_to_sort, values, size);
+        introSort(values_to_sort, size);
+        printf("After introsort: ");
+        printArray(values_to_sort, size);
+
+        CopyArray(values_to_sort, values, size);
+        quickSort(values_to_sort, size, nullptr, nullptr, THREE_WAY);
+        printf("After quicksort with three-way partitioning: ");
+        printArray(values_to_sort, size);
+
+        CopyArray(values_to_sort, values, size);
+        quickSort(values_to_sort, size, nullptr, nullptr, BLOCK);
+        printf("After quicksort with block partitioning: ");
+        printArray(values_to_sort, size);
+
+        CopyArray(values_to_sort, values, size);
+        printf("The 3rd smallest element from that array is (quickselect, three-way): %d\n",
+               quickSelect(values_to_sort, size, 2, nullptr, nullptr, THREE_WAY));
         printf("The 3rd smallest element from that array is (quickselect): %d\n", quickSelect(values, size, 2));
     }
 
@@ -303,6 +799,402 @@ namespace lab03
         REQUIRE( IsSorted(data, size) );
     }
 
+    // runs the job on a thread with a stack of the given size (on the calling thread where pthreads are missing)
+    void runWithStack(const size_t stackBytes, const std::function<void()>& job)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, stackBytes);
+        pthread_t thread;
+        auto trampoline = [](void* arg) -> void* {
+            (*static_cast<const std::function<void()>*>(arg))();
+            return nullptr;
+        };
+        if (pthread_create(&thread, &attr, trampoline, const_cast<std::function<void()>*>(&job)) == 0) {
+            pthread_join(thread, nullptr);
+        } else {
+            job();
+        }
+        pthread_attr_destroy(&attr);
+#else
+        job();
+#endif
+    }
+
+    TEST_CASE("Bounded stack")
+    {
+        // sorted inputs split into ranges of n - 1 and 0 elements at every step: n nested calls before, a 64 KiB
+        // stack overflows after a few thousand of them
+        constexpr int size = 10000;
+        std::vector<int> sorted(size), quick, hybrid, select;
+        for (int i = 0; i < size; i++) {
+            sorted[i] = i;
+        }
+        quick = hybrid = select = sorted;
+        std::reverse(quick.begin(), quick.end());
+        int smallest = -1;
+        runWithStack(64 * 1024, [&]() {
+            quickSort(quick.data(), size);
+            hybridizedQuickSort(hybrid.data(), size, nullptr, nullptr, 16);
+            smallest = quickSelect(select.data(), size, 0);
+        });
+        REQUIRE( quick == sorted );
+        REQUIRE( hybrid == sorted );
+        REQUIRE( smallest == 0 );
+
+        // the loop does the same partitions as the recursion did
+        Profiler p("bounded stack");
+        Operation asg = p.createOperation("asg", size);
+        Operation cmp = p.createOperation("cmp", size);
+        quickSort(sorted.data(), 1000, &asg, &cmp);
+        REQUIRE( cmp.get() == 1000 * 999 / 2 );
+    }
+
+    TEST_CASE("Introsort")
+    {
+        // the inputs that make the last element pivot quadratic, and a deep recursion for quickSort
+        constexpr int size = 1000000;
+        std::vector<int> data(size);
+        const int orders[] = {UNSORTED, ASCENDING, DESCENDING};
+        for (int order : orders) {
+            FillRandomArray(data.data(), size, 10, 50000, false, order);
+            introSort(data.data(), size);
+            REQUIRE( IsSorted(data.data(), size) );
+        }
+
+        // all equal, organ pipe and sawtooth
+        std::fill(data.begin(), data.end(), 7);
+        introSort(data.data(), size);
+        REQUIRE( IsSorted(data.data(), size) );
+        for (int i = 0; i < size; i++) {
+            data[i] = i < size / 2 ? i : size - i;
+        }
+        introSort(data.data(), size);
+        REQUIRE( IsSorted(data.data(), size) );
+        for (int i = 0; i < size; i++) {
+            data[i] = i % 1000;
+        }
+        introSort(data.data(), size);
+        REQUIRE( IsSorted(data.data(), size) );
+
+        // O(n log n) operations on the worst case of quickSort
+        Profiler p("introsort");
+        Operation asg = p.createOperation("asg", 100000);
+        Operation cmp = p.createOperation("cmp", 100000);
+        FillRandomArray(data.data(), 100000, 10, 50000, false, DESCENDING);
+        introSort(data.data(), 100000, &asg, &cmp);
+        REQUIRE( IsSorted(data.data(), 100000) );
+        REQUIRE( cmp.get() < 100000 * 17 * 3 );
+    }
+
+    TEST_CASE("Three-way partitioning")
+    {
+        constexpr int size = 40000;
+        std::vector<int> values(size), data, expected;
+        // few distinct values, all distinct values, and the degenerate all equal input
+        const int ranges[] = {1, 2, 20, 1000, 50000};
+        for (int range : ranges) {
+            if (range == 1) {
+                std::fill(values.begin(), values.end(), 1);
+            } else {
+                FillRandomArray(values.data(), size, 1, range, range >= size);
+            }
+            expected = values;
+            std::sort(expected.begin(), expected.end());
+
+            data = values;
+            quickSort(data.data(), size, nullptr, nullptr, THREE_WAY);
+            REQUIRE( data == expected );
+
+            data = values;
+            hybridizedQuickSort(data.data(), size, nullptr, nullptr, TUNED_THRESHOLD, THREE_WAY);
+            REQUIRE( data == expected );
+
+            for (int k = 0; k < size; k += 997) {
+                data = values;
+                REQUIRE( quickSelect(data.data(), size, k, nullptr, nullptr, THREE_WAY) == expected[k] );
+            }
+        }
+
+        // every small size, where the scans run into both ends of the range
+        for (int n = 1; n < 64; n++) {
+            for (int rep = 0; rep < 20; rep++) {
+                data.resize(n);
+                FillRandomArray(data.data(), n, 1, 4);
+                expected = data;
+                std::sort(expected.begin(), expected.end());
+                quickSort(data.data(), n, nullptr, nullptr, THREE_WAY);
+                REQUIRE( data == expected );
+            }
+        }
+
+        // linear on an all equal input, where Lomuto is quadratic
+        Profiler p("three-way");
+        Operation asg = p.createOperation("asg", size);
+        Operation cmp = p.createOperation("cmp", size);
+        std::fill(values.begin(), values.end(), 5);
+        quickSort(values.data(), size, &asg, &cmp, THREE_WAY);
+        REQUIRE( cmp.get() < 3 * size );
+    }
+
+    TEST_CASE("Block partitioning")
+    {
+        std::vector<int> values, data, expected;
+        // sizes around the multiples of the block, where the block loop hands over to the scan from both ends
+        const int sizes[] = {1, 2, 3, 100, 255, 256, 257, 383, 384, 385, 1000, 4099, 40000};
+        const int ranges[] = {2, 20, 50000};
+        for (int n : sizes) {
+            for (int range : ranges) {
+                values.resize(n);
+                FillRandomArray(values.data(), n, 1, range);
+                expected = values;
+                std::sort(expected.begin(), expected.end());
+
+                data = values;
+                quickSort(data.data(), n, nullptr, nullptr, BLOCK);
+                REQUIRE( data == expected );
+
+                data = values;
+                hybridizedQuickSort(data.data(), n, nullptr, nullptr, TUNED_THRESHOLD, BLOCK);
+                REQUIRE( data == expected );
+
+                for (int k = 0; k < n; k += n / 7 + 1) {
+                    data = values;
+                    REQUIRE( quickSelect(data.data(), n, k, nullptr, nullptr, BLOCK) == expected[k] );
+                }
+            }
+        }
+    }
+
+    TEST_CASE("Vectorized partitioning")
+    {
+        std::vector<VectorKernel> kernels = {KERNEL_BLOCK};
+        if (cpuSupportsSse41()) kernels.push_back(KERNEL_SSE);
+        if (cpuSupportsAvx2()) kernels.push_back(KERNEL_AVX2);
+
+        std::vector<int> values, data, expected;
+        const int ranges[] = {1, 2, 20, 50000};
+        for (VectorKernel kernel : kernels) {
+            // every way the middle can be left over after the vector loop, then a few large ranges
+            for (int n = 1; n <= 4200; n += n < 300 ? 1 : 977) {
+                for (int range : ranges) {
+                    values.resize(n);
+                    for (int& x : values) x = rand() % range - range / 2;
+                    expected = values;
+                    std::sort(expected.begin(), expected.end());
+
+                    data = values;
+                    const int p = partitionVector(data.data(), 0, n - 1, kernel, nullptr, nullptr);
+                    REQUIRE( data[p] == values[n - 1] );
+                    for (int i = 0; i < p; i++) REQUIRE( data[i] <= data[p] );
+                    for (int i = p + 1; i < n; i++) REQUIRE( data[i] >= data[p] );
+                    std::sort(data.begin(), data.end());
+                    REQUIRE( data == expected );
+                }
+            }
+        }
+
+        // the equal elements are split between both sides, so a single value does not degrade to n^2
+        const int size = 100000;
+        values.assign(size, 7);
+        Profiler p("vector");
+        Operation cmp = p.createOperation("cmp", size);
+        quickSort(values.data(), size, nullptr, &cmp, VECTOR);
+        REQUIRE( cmp.get() < 40 * size );
+
+        const int sizes[] = {1, 2, 3, 63, 64, 65, 100, 1000, 4099, 40000};
+        for (int n : sizes) {
+            for (int range : ranges) {
+                values.resize(n);
+                for (int& x : values) x = rand() % range;
+                expected = values;
+                std::sort(expected.begin(), expected.end());
+
+                data = values;
+                quickSort(data.data(), n, nullptr, nullptr, VECTOR);
+                REQUIRE( data == expected );
+
+                data = values;
+                hybridizedQuickSort(data.data(), n, nullptr, nullptr, TUNED_THRESHOLD, VECTOR);
+                REQUIRE( data == expected );
+
+                for (int k = 0; k < n; k += n / 7 + 1) {
+                    data = values;
+                    REQUIRE( quickSelect(data.data(), n, k, nullptr, nullptr, VECTOR) == expected[k] );
+                }
+            }
+        }
+    }
+
+    struct Record { // same layout as lab05::Entry
+        int id;
+        char name[30];
+    };
+
+    struct Edge { // same layout as lab08::Edge
+        int from, to;
+        int weight;
+    };
+
+    TEST_CASE("Generic sorting")
+    {
+        constexpr int size = 40000;
+        std::vector<int> ints(size);
+        FillRandomArray(ints.data(), size);
+        std::vector<int> expected(ints);
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<int> data(ints);
+        sorting::quick_sort(data.begin(), data.end());
+        REQUIRE( data == expected );
+
+        data = ints;
+        sorting::heap_sort(data.begin(), data.end());
+        REQUIRE( data == expected );
+
+        data.assign(ints.begin(), ints.begin() + 2000);
+        sorting::insertion_sort(data.begin(), data.end(), sorting::greater());
+        REQUIRE( std::is_sorted(data.begin(), data.end(), std::greater<int>()) );
+
+        data.assign(ints.begin(), ints.begin() + 2000);
+        sorting::binary_insertion_sort(data.begin(), data.end());
+        REQUIRE( std::is_sorted(data.begin(), data.end()) );
+
+        // already sorted and reverse sorted inputs
+        data = expected;
+        sorting::quick_sort(data.begin(), data.end());
+        REQUIRE( data == expected );
+        std::reverse(data.begin(), data.end());
+        sorting::quick_sort(data.begin(), data.end());
+        REQUIRE( data == expected );
+
+        data = ints;
+        sorting::quick_select(data.begin(), data.begin() + size / 2, data.end());
+        REQUIRE( data[size / 2] == expected[size / 2] );
+
+        // all equal and few distinct keys split in the middle, Lomuto sends every equal key to one side (n^2)
+        constexpr int large = 100000;
+        const int ranges[] = {1, 2, 20};
+        for (int range : ranges) {
+            std::vector<int> keys(large);
+            for (int& x : keys) x = rand() % range;
+            std::vector<int> sorted(keys);
+            std::sort(sorted.begin(), sorted.end());
+
+            Profiler p("generic-duplicates");
+            Operation cmp = p.createOperation("cmp", large);
+            data = keys;
+            sorting::quick_sort(data.begin(), data.end(), sorting::less(), sorting::identity(), nullptr, &cmp);
+            REQUIRE( data == sorted );
+            REQUIRE( cmp.get() < 30 * large );
+
+            for (int k = 0; k < large; k += large / 7) {
+                Profiler selectProfiler("generic-select");
+                Operation selectCmp = selectProfiler.createOperation("cmp", large);
+                data = keys;
+                sorting::quick_select(data.begin(), data.begin() + k, data.end(), sorting::less(), sorting::identity(),
+                                      nullptr, &selectCmp);
+                REQUIRE( data[k] == sorted[k] );
+                REQUIRE( std::count_if(data.begin(), data.begin() + k, [&](int x) { return x > data[k]; }) == 0 );
+                REQUIRE( std::count_if(data.begin() + k, data.end(), [&](int x) { return x < data[k]; }) == 0 );
+                REQUIRE( selectCmp.get() < 10 * large );
+            }
+        }
+    }
+
+    TEST_CASE("Generic sorting of records")
+    {
+        constexpr int size = 10000;
+        std::vector<Edge> edges(size);
+        for (int i = 0; i < size; i++) {
+            edges[i].from = i;
+            edges[i].to = i + 1;
+            edges[i].weight = rand() % 3600 + 1;
+        }
+        sorting::quick_sort(edges.begin(), edges.end(), sorting::less(), [](const Edge& e) { return e.weight; });
+        for (int i = 1; i < size; i++) {
+            REQUIRE( edges[i - 1].weight <= edges[i].weight );
+        }
+
+        // stable sort by name keeps the ids of equal names in order
+        std::vector<Record> entries(size);
+        for (int i = 0; i < size; i++) {
+            entries[i].id = i;
+            snprintf(entries[i].name, sizeof(entries[i].name), "name%d", rand() % 100);
+        }
+        sorting::binary_insertion_sort(entries.begin(), entries.end(), sorting::less(),
+                                       [](const Record& e) { return std::string(e.name); });
+        for (int i = 1; i < size; i++) {
+            const int order = strcmp(entries[i - 1].name, entries[i].name);
+            REQUIRE( order <= 0 );
+            if (order == 0) {
+                REQUIRE( entries[i - 1].id < entries[i].id );
+            }
+        }
+
+        std::vector<std::string> words;
+        for (int i = 0; i < size; i++) {
+            words.push_back(std::to_string(rand()));
+        }
+        sorting::heap_sort(words.begin(), words.end());
+        REQUIRE( std::is_sorted(words.begin(), words.end()) );
+
+        // elements that cannot be copied at all are moved
+        std::vector<std::unique_ptr<int>> pointers;
+        for (int i = 0; i < size; i++) {
+            pointers.push_back(std::unique_ptr<int>(new int(rand())));
+        }
+        sorting::quick_sort(pointers.begin(), pointers.end(), sorting::less(),
+                            [](const std::unique_ptr<int>& p) { return *p; });
+        for (int i = 1; i < size; i++) {
+            REQUIRE( *pointers[i - 1] <= *pointers[i] );
+        }
+    }
+
+    struct LargeRecord {
+        int key;
+        char payload[252];
+    };
+
+    TEST_CASE("Argsort")
+    {
+        constexpr int size = 20000;
+        std::vector<LargeRecord> records(size);
+        for (int i = 0; i < size; i++) {
+            records[i].key = rand() % 1000;
+            snprintf(records[i].payload, sizeof(records[i].payload), "%d", i); // remembers the original position
+        }
+        const auto key = [](const LargeRecord& r) { return r.key; };
+
+        const sorting::Engine engines[] = {sorting::QUICK_SORT, sorting::HEAP_SORT};
+        for (sorting::Engine engine : engines) {
+            std::vector<std::uint32_t> order(size);
+            sorting::argsort(records.begin(), records.end(), order.data(), sorting::less(), key, nullptr, nullptr, engine);
+
+            // stable: equal keys keep their original order
+            for (int i = 1; i < size; i++) {
+                const LargeRecord& a = records[order[i - 1]];
+                const LargeRecord& b = records[order[i]];
+                REQUIRE( (a.key < b.key || (a.key == b.key && order[i - 1] < order[i])) );
+            }
+
+            std::vector<LargeRecord> sorted(records);
+            const std::vector<std::uint32_t> permutation(order);
+            sorting::apply_permutation(sorted.begin(), sorted.end(), order.data());
+            for (int i = 0; i < size; i++) {
+                REQUIRE( atoi(sorted[i].payload) == (int)permutation[i] );
+                REQUIRE( order[i] == (std::uint32_t)i ); // the permutation is consumed
+            }
+        }
+
+        std::vector<std::string> words = {"pear", "apple", "fig", "kiwi"};
+        std::uint32_t order[4];
+        sorting::argsort(words.begin(), words.end(), order, sorting::greater());
+        sorting::apply_permutation(words.begin(), words.end(), order);
+        REQUIRE( words == std::vector<std::string>({"pear", "kiwi", "fig", "apple"}) );
+    }
+
     void constructBestCase(int* values, const int l, const int r) {
         if (l >= r) {
             return;
@@ -420,11 +1312,17 @@ namespace lab03
                         Operation hqAsg = profiler.createOperation("hqAsg", n);
                         Operation hqCmp = profiler.createOperation("hqCmp", n);
 
+                        Operation iqAsg = profiler.createOperation("iqAsg", n);
+                        Operation iqCmp = profiler.createOperation("iqCmp", n);
+
                         CopyArray(values_to_process, values, n);
                         quickSort(values_to_process, n, &qAsg, &qCmp);
 
                         CopyArray(values_to_process, values, n);
                         hybridizedQuickSort(values_to_process, n, &hqAsg, &hqCmp);
+
+                        CopyArray(values_to_process, values, n);
+                        introSort(values_to_process, n, &iqAsg, &iqCmp);
                     }
                 }
 
@@ -434,13 +1332,17 @@ namespace lab03
                 profiler.divideValues("hqAsg", 5);
                 profiler.divideValues("hqCmp", 5);
 
+                profiler.divideValues("iqAsg", 5);
+                profiler.divideValues("iqCmp", 5);
+
                 profiler.addSeries("qOp", "qAsg", "qCmp");
                 profiler.addSeries("hqOp", "hqAsg", "hqCmp");
+                profiler.addSeries("iqOp", "iqAsg", "iqCmp");
 
 
-                profiler.createGroup("Assignments", "qAsg", "hqAsg");
-                profiler.createGroup("Comparisons", "qCmp", "hqCmp");
-                profiler.createGroup("Operations", "qOp", "hqOp");
+                profiler.createGroup("Assignments", "qAsg", "hqAsg", "iqAsg");
+                profiler.createGroup("Comparisons", "qCmp", "hqCmp", "iqCmp");
+                profiler.createGroup("Operations", "qOp", "hqOp", "iqOp");
                 break;
             }
         default:
@@ -511,12 +1413,153 @@ namespace lab03
                         hybridizedQuickSort(values_to_process, n);
                     }
                     profiler.stopTimer("hqSort", n);
+
+                    profiler.startTimer("iqSort", n);
+                    for (int i = 0; i < 1000; i++) {
+                        printf("n(%d): i(%d)\n", n, i + 1);
+                        CopyArray(values_to_process, values, n);
+                        introSort(values_to_process, n);
+                    }
+                    profiler.stopTimer("iqSort", n);
                 }
-                profiler.createGroup("Runtime", "qSort", "hqSort");
+                profiler.createGroup("Runtime", "qSort", "hqSort", "iqSort");
                 break;
             }
         }
         profiler.showReport();
     }
 
+    void benchmarkPartitions(Profiler& profiler)
+    {
+        printf("Comparing the partitioning schemes on random inputs, times for 5 runs\n");
+        const PartitionScheme schemes[] = {LOMUTO, THREE_WAY, BLOCK, VECTOR};
+        const char* sortNames[] = {"hqLomuto", "hqThreeWay", "hqBlock", "hqVector"};
+        const char* selectNames[] = {"selectLomuto", "selectThreeWay", "selectBlock", "selectVector"};
+        constexpr int max_size = 1000000;
+        std::vector<int> values(max_size), data(max_size);
+        for (int n = 100000; n <= max_size; n += 100000) {
+            printf("n(%d)\n", n);
+            FillRandomArray(values.data(), n, 0, 1000000000);
+            for (int s = 0; s < 4; s++) {
+                profiler.startTimer(sortNames[s], n);
+                for (int i = 0; i < 5; i++) {
+                    std::copy(values.begin(), values.begin() + n, data.begin());
+                    hybridizedQuickSort(data.data(), n, nullptr, nullptr, TUNED_THRESHOLD, schemes[s]);
+                }
+                profiler.stopTimer(sortNames[s], n);
+
+                profiler.startTimer(selectNames[s], n);
+                for (int i = 0; i < 5; i++) {
+                    std::copy(values.begin(), values.begin() + n, data.begin());
+                    quickSelect(data.data(), n, n / 2, nullptr, nullptr, schemes[s]);
+                }
+                profiler.stopTimer(selectNames[s], n);
+            }
+        }
+        profiler.createGroup("Hybrid quick sort", "hqLomuto", "hqThreeWay", "hqBlock", "hqVector");
+        profiler.createGroup("Quick select", "selectLomuto", "selectThreeWay", "selectBlock", "selectVector");
+        profiler.showReport();
+    }
+
+    void benchmarkDuplicates(Profiler& profiler)
+    {
+        printf("Comparing Lomuto and three-way partitioning on inputs with 20 distinct values\n");
+        constexpr int max_size = 100000;
+        std::vector<int> values(max_size), data(max_size);
+        for (int n = 10000; n <= max_size; n += 10000) {
+            printf("n(%d)\n", n);
+            FillRandomArray(values.data(), n, 1, 20);
+
+            profiler.startTimer("qLomuto", n);
+            std::copy(values.begin(), values.begin() + n, data.begin());
+            quickSort(data.data(), n);
+            profiler.stopTimer("qLomuto", n);
+
+            profiler.startTimer("qThreeWay", n);
+            std::copy(values.begin(), values.begin() + n, data.begin());
+            quickSort(data.data(), n, nullptr, nullptr, THREE_WAY);
+            profiler.stopTimer("qThreeWay", n);
+
+            profiler.startTimer("hqLomuto", n);
+            std::copy(values.begin(), values.begin() + n, data.begin());
+            hybridizedQuickSort(data.data(), n);
+            profiler.stopTimer("hqLomuto", n);
+
+            profiler.startTimer("hqThreeWay", n);
+            std::copy(values.begin(), values.begin() + n, data.begin());
+            hybridizedQuickSort(data.data(), n, nullptr, nullptr, TUNED_THRESHOLD, THREE_WAY);
+            profiler.stopTimer("hqThreeWay", n);
+
+            profiler.startTimer("selectLomuto", n);
+            std::copy(values.begin(), values.begin() + n, data.begin());
+            quickSelect(data.data(), n, n / 2);
+            profiler.stopTimer("selectLomuto", n);
+
+            profiler.startTimer("selectThreeWay", n);
+            std::copy(values.begin(), values.begin() + n, data.begin());
+            quickSelect(data.data(), n, n / 2, nullptr, nullptr, THREE_WAY);
+            profiler.stopTimer("selectThreeWay", n);
+        }
+        profiler.createGroup("Sorting few distinct values", "qLomuto", "qThreeWay", "hqLomuto", "hqThreeWay");
+        profiler.createGroup("Selecting among few distinct values", "selectLomuto", "selectThreeWay");
+        profiler.showReport();
+    }
+
+    void benchmarkRecords(Profiler& profiler)
+    {
+        printf("Comparing direct and indirect (argsort) sorting of 256 byte records\n");
+        const auto key = [](const LargeRecord& r) { return r.key; };
+        constexpr int max_size = 100000;
+        std::vector<int> keys(max_size), ints(max_size);
+        std::vector<LargeRecord> values(max_size), records(max_size);
+        std::vector<std::uint32_t> order(max_size);
+        for (int n = 10000; n <= max_size; n += 10000) {
+            printf("n(%d)\n", n);
+            FillRandomArray(keys.data(), n);
+            for (int i = 0; i < n; i++) {
+                values[i].key = keys[i];
+            }
+
+            profiler.startTimer("ints", n);
+            for (int i = 0; i < 10; i++) {
+                std::copy(keys.begin(), keys.begin() + n, ints.begin());
+                sorting::quick_sort(ints.begin(), ints.begin() + n);
+            }
+            profiler.stopTimer("ints", n);
+
+            profiler.startTimer("recordsQuickSort", n);
+            for (int i = 0; i < 10; i++) {
+                std::copy(values.begin(), values.begin() + n, records.begin());
+                sorting::quick_sort(records.begin(), records.begin() + n, sorting::less(), key);
+            }
+            profiler.stopTimer("recordsQuickSort", n);
+
+            profiler.startTimer("recordsHeapSort", n);
+            for (int i = 0; i < 10; i++) {
+                std::copy(values.begin(), values.begin() + n, records.begin());
+                sorting::heap_sort(records.begin(), records.begin() + n, sorting::less(), key);
+            }
+            profiler.stopTimer("recordsHeapSort", n);
+
+            profiler.startTimer("argsortQuickSort", n);
+            for (int i = 0; i < 10; i++) {
+                std::copy(values.begin(), values.begin() + n, records.begin());
+                sorting::argsort(records.begin(), records.begin() + n, order.data(), sorting::less(), key);
+                sorting::apply_permutation(records.begin(), records.begin() + n, order.data());
+            }
+            profiler.stopTimer("argsortQuickSort", n);
+
+            profiler.startTimer("argsortHeapSort", n);
+            for (int i = 0; i < 10; i++) {
+                std::copy(values.begin(), values.begin() + n, records.begin());
+                sorting::argsort(records.begin(), records.begin() + n, order.data(), sorting::less(), key,
+                                 nullptr, nullptr, sorting::HEAP_SORT);
+                sorting::apply_permutation(records.begin(), records.begin() + n, order.data());
+            }
+            profiler.stopTimer("argsortHeapSort", n);
+        }
+        profiler.createGroup("Record sorting", "ints", "recordsQuickSort", "recordsHeapSort", "argsortQuickSort", "argsortHeapSort");
+        profiler.showReport();
+    }
+
 } // namespace lab03
@@ -3,10 +3,36 @@
 
 #include "Profiler.h"
 #include "commandline.h"
+#include "threshold_tuning.h"
 
 namespace lab03
 {
 
+	/**
+	 * @brief How quickSort, hybridizedQuickSort and quickSelect partition a range around its last element
+	 *
+	 * LOMUTO: one scan, the elements equal to the pivot go to the left side.
+	 * THREE_WAY: Bentley-McIlroy, the elements equal to the pivot are gathered in the middle and left out of
+	 *            the recursion, so an input with few distinct values is sorted in close to linear time.
+	 * BLOCK: BlockQuicksort (Edelkamp and Weiss), the comparisons of a block of elements are stored as offsets
+	 *        without branching and the misplaced elements are swapped afterwards, so nothing mispredicts.
+	 * VECTOR: 8 elements (4 without AVX2) are compared with the pivot at once and permuted by a lookup table so
+	 *         that they can be stored on both sides, the kernel is picked from the CPU at run time. An element
+	 *         equal to the pivot goes left or right in turns, vector by vector. Ranges shorter than PARTITION_VECTOR_MIN and
+	 *         CPUs without SSE4.1 use BLOCK.
+	 */
+	enum PartitionScheme { LOMUTO, THREE_WAY, BLOCK, VECTOR };
+
+	/**
+	 * @brief Number of elements scanned at once from each side by the BLOCK partition
+	 */
+	constexpr int PARTITION_BLOCK = 128;
+
+	/**
+	 * @brief Smallest range partitioned by the VECTOR kernels
+	 */
+	constexpr int PARTITION_VECTOR_MIN = 64;
+
 	/**
 	 * @brief Quick sort algorithm
 	 *
@@ -14,8 +40,9 @@ namespace lab03
 	 * @param n number of values in the input array
 	 * @param opAsg optional counter for assignment operations
 	 * @param opCmp optional counter for comparison operations
+	 * @param scheme partitioning scheme
 	 */
-	void quickSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr);
+	void quickSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr, PartitionScheme scheme = LOMUTO);
 
 	void insertionSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr);
 
@@ -26,8 +53,53 @@ namespace lab03
 	 * @param n number of values in the input array
 	 * @param opAsg optional counter for assignment operations
 	 * @param opCmp optional counter for comparison operations
+	 * @param threshold largest range sorted by insertion sort, TUNED_THRESHOLD for hybridThreshold()
+	 * @param scheme partitioning scheme
+	 */
+	void hybridizedQuickSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr,
+	                         int threshold = TUNED_THRESHOLD,
+	                         PartitionScheme scheme = LOMUTO);
+
+	/**
+	 * @brief Introsort: hybridized quick sort that cannot degrade to O(n^2) or overflow the stack
+	 *
+	 * The pivot is the median of the first, middle and last element, or for more than INTRO_NINTHER_SIZE
+	 * elements the median of three such medians (Tukey's ninther). Past a recursion depth of 2 * log2(n) the
+	 * remaining range is sorted by heapSort, ranges of up to threshold elements by insertion sort.
+	 *
+	 * @param values array of input values to be sorted
+	 * @param n number of values in the input array
+	 * @param opAsg optional counter for assignment operations
+	 * @param opCmp optional counter for comparison operations
+	 * @param threshold largest range sorted by insertion sort, TUNED_THRESHOLD for hybridThreshold()
+	 * @param scheme partitioning scheme
+	 */
+	void introSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr,
+	               int threshold = TUNED_THRESHOLD, PartitionScheme scheme = LOMUTO);
+
+	/**
+	 * @brief Partitions values[l..r] around its last element values[r] with the given scheme
+	 *
+	 * @param lt set to the first position of the elements equal to the pivot (one element unless THREE_WAY is used)
+	 * @param gt set to the last position of the elements equal to the pivot
 	 */
-	void hybridizedQuickSort(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr, int threshold = 29);
+	void partitionRange(int* values, int l, int r, int& lt, int& gt, PartitionScheme scheme,
+	                    Operation* opAsg = nullptr, Operation* opCmp = nullptr);
+
+	/**
+	 * @brief One partition step of introSort: the pivot is picked like in introSort and values[l..r] is partitioned
+	 *        around it with the given scheme
+	 *
+	 * @param lt set to the first position of the elements equal to the pivot (one element unless THREE_WAY is used)
+	 * @param gt set to the last position of the elements equal to the pivot
+	 */
+	void pivotPartition(int* values, int l, int r, int& lt, int& gt, PartitionScheme scheme = BLOCK,
+	                    Operation* opAsg = nullptr, Operation* opCmp = nullptr);
+
+	/**
+	 * @brief Ranges longer than this pick the pivot with the ninther instead of the median of 3
+	 */
+	constexpr int INTRO_NINTHER_SIZE = 128;
 
 	/**
 	 * @brief Quick select algorithm
@@ -37,8 +109,9 @@ namespace lab03
 	 * @param k
 	 * @param opAsg optional counter for assignment operations
 	 * @param opCmp optional counter for comparison operations
+	 * @param scheme partitioning scheme
 	 */
-	int quickSelect(int* values, int n, int k, Operation* opAsg = nullptr, Operation* opCmp = nullptr);
+	int quickSelect(int* values, int n, int k, Operation* opAsg = nullptr, Operation* opCmp = nullptr, PartitionScheme scheme = LOMUTO);
 
 	/**
 	 * @brief Heap sort algorithm
@@ -74,6 +147,27 @@ namespace lab03
 	 */
 	void benchmark(Profiler& profiler, AnalysisCase whichCase);
 
+	/**
+	 * @brief Benchmarking of the partitioning schemes on inputs with few distinct values
+	 *
+	 * @param profiler profiler to use
+	 */
+	void benchmarkDuplicates(Profiler& profiler);
+
+	/**
+	 * @brief Benchmarking of the partitioning schemes on random inputs
+	 *
+	 * @param profiler profiler to use
+	 */
+	void benchmarkPartitions(Profiler& profiler);
+
+	/**
+	 * @brief Benchmarking of direct sorting against argsort on large records
+	 *
+	 * @param profiler profiler to use
+	 */
+	void benchmarkRecords(Profiler& profiler);
+
 } // namespace lab03
 
 #endif // __QUICK_SORT_H__
\ No newline at end of file
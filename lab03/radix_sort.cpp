@@ -0,0 +1,341 @@
+#include "radix_sort.h"
+#include "quick_sort.h"
+
+#include "catch2.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+/*
+ * ---------- RADIX SORT ----------
+ * All the other sorts of the lab compare keys, which costs at least log2(n!) ~ n log2(n) comparisons: ~27 per element
+ * at 10^8 elements, each one a branch the CPU cannot predict on random data. A radix sort never compares: LSD reads
+ * every value once to count all of its digits and then moves it once per digit, so 4 / 3 / 2 passes over the array
+ * for 8 / 11 / 16-bit digits whatever n is. Fewer passes are not free: a pass scatters into 2^digitBits places at
+ * once, and with 65536 of them the write positions no longer fit in L1 and the writes miss the cache.
+ * MSD works in place (American flag sort), one cycle of swaps per bucket, and ends in insertion sort for the small
+ * buckets: the first digit already splits 10^6 random values into buckets of ~4000, the second into ~15.
+ * Signed ints and floats become unsigned keys in the same order with a bit flip, computed again in every pass
+ * instead of being stored.
+ * bench_radix, random ints in [-10^9, 10^9], ns per element (10^6 / 10^8 elements):
+ *     quickSort 128 / 198, hybridizedQuickSort 116 / 168, std::sort 94 / 137
+ *     LSD 8 bits 24 / 40, 11 bits 20 / 30, 16 bits 27 / 44, MSD 43 / 70
+ * so LSD with 11-bit digits is 5-6x faster than the quick sorts, and its cost per element barely grows with n while
+ * theirs grows with log n. With 16-bit digits the two histograms of 65536 counters cost more than sorting 1000
+ * values (124 ns per element there). MSD trades ~2x of the speed of LSD for sorting in place: a swap cycle is a chain
+ * of dependent loads to random places. The MSD cutoff hardly matters between 16 and 256 (+-10% noise), without it
+ * (cutoff 0) 10^7 values take 4x longer because every bucket of a few values still walks 256 counters.
+ * Floats in [-10^6, 10^6] sort a bit faster than the ints with LSD (16 / 22 ns per element at 10^6 / 10^8): their
+ * exponents only take a few values, so the pass of the highest digit writes to a handful of buckets.
+ */
+
+namespace lab03
+{
+    namespace
+    {
+        // signed ints in unsigned order: the sign bit flipped puts the negative ones first
+        struct IntKey
+        {
+            static uint32_t key(const int x) { return (uint32_t)x ^ 0x80000000u; }
+        };
+
+        // positive floats are ordered like their bits, which are then above all the negative ones; the bits of
+        // the negative floats grow with the magnitude, flipping all of them reverses that
+        struct FloatKey
+        {
+            static uint32_t key(const float x)
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &x, sizeof(bits));
+                return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+            }
+        };
+
+        template <typename T, typename Key>
+        void radix_lsd(T* values, const int n, Operation* opAsg, int digitBits)
+        {
+            if (n <= 1) {
+                return;
+            }
+            digitBits = std::max(1, std::min(digitBits, 16));
+            const int passes = (32 + digitBits - 1) / digitBits;
+            const int buckets = 1 << digitBits;
+            const uint32_t mask = (uint32_t)buckets - 1;
+
+            // the histograms of all the digits in one read of the input
+            std::vector<int> counts((size_t)passes * buckets, 0);
+            for (int i = 0; i < n; i++) {
+                const uint32_t key = Key::key(values[i]);
+                for (int p = 0; p < passes; p++) {
+                    counts[(size_t)p * buckets + ((key >> (p * digitBits)) & mask)]++;
+                }
+            }
+
+            std::vector<T> buffer(n);
+            T* src = values;
+            T* dst = buffer.data();
+            for (int p = 0; p < passes; p++) {
+                int* count = counts.data() + (size_t)p * buckets;
+                const int shift = p * digitBits;
+                if (count[(Key::key(src[0]) >> shift) & mask] == n) {
+                    continue; // the same digit everywhere, the pass would not change the order
+                }
+                // where the first value with every digit goes
+                int sum = 0;
+                for (int b = 0; b < buckets; b++) {
+                    const int c = count[b];
+                    count[b] = sum;
+                    sum += c;
+                }
+                for (int i = 0; i < n; i++) {
+                    const T x = src[i];
+                    dst[count[(Key::key(x) >> shift) & mask]++] = x;
+                }
+                if (opAsg) opAsg->count(n);
+                std::swap(src, dst);
+            }
+            if (src != values) {
+                std::copy(src, src + n, values);
+                if (opAsg) opAsg->count(n);
+            }
+        }
+
+        template <typename T, typename Key>
+        void insertionByKey(T* values, const int n, Operation* opAsg, Operation* opCmp)
+        {
+            for (int i = 1; i < n; i++) {
+                const T x = values[i];
+                const uint32_t key = Key::key(x);
+                if (opAsg) opAsg->count();
+                int j = i - 1;
+                while (j >= 0) {
+                    if (opCmp) opCmp->count();
+                    if (!(key < Key::key(values[j]))) {
+                        break;
+                    }
+                    values[j + 1] = values[j];
+                    if (opAsg) opAsg->count();
+                    j--;
+                }
+                values[j + 1] = x;
+                if (opAsg) opAsg->count();
+            }
+        }
+
+        template <typename T, typename Key>
+        void radix_msd(T* values, const int n, const int shift, const int cutoff, Operation* opAsg, Operation* opCmp)
+        {
+            if (n <= cutoff) {
+                insertionByKey<T, Key>(values, n, opAsg, opCmp);
+                return;
+            }
+
+            int count[256] = {0};
+            for (int i = 0; i < n; i++) {
+                count[(Key::key(values[i]) >> shift) & 0xFF]++;
+            }
+            int start[257], next[256];
+            start[0] = 0;
+            for (int b = 0; b < 256; b++) {
+                start[b + 1] = start[b] + count[b];
+                next[b] = start[b];
+            }
+
+            // every value taken out of a bucket that is not its own is carried to the next free place of its
+            // bucket, and the value found there is carried on, until one that belongs to the first bucket comes
+            for (int b = 0; b < 256; b++) {
+                while (next[b] < start[b + 1]) {
+                    T x = values[next[b]];
+                    int digit = (Key::key(x) >> shift) & 0xFF;
+                    while (digit != b) {
+                        std::swap(x, values[next[digit]++]);
+                        if (opAsg) opAsg->count();
+                        digit = (Key::key(x) >> shift) & 0xFF;
+                    }
+                    values[next[b]++] = x;
+                    if (opAsg) opAsg->count();
+                }
+            }
+
+            if (shift == 0) {
+                return;
+            }
+            for (int b = 0; b < 256; b++) {
+                if (count[b] > 1) {
+                    radix_msd<T, Key>(values + start[b], count[b], shift - 8, cutoff, opAsg, opCmp);
+                }
+            }
+        }
+    }
+
+    void radixSortLSD(int* values, const int n, Operation* opAsg, Operation* opCmp, const int digitBits)
+    {
+        radix_lsd<int, IntKey>(values, n, opAsg, digitBits);
+    }
+
+    void radixSortLSD(float* values, const int n, Operation* opAsg, Operation* opCmp, const int digitBits)
+    {
+        radix_lsd<float, FloatKey>(values, n, opAsg, digitBits);
+    }
+
+    void radixSortMSD(int* values, const int n, Operation* opAsg, Operation* opCmp, const int cutoff)
+    {
+        radix_msd<int, IntKey>(values, n, 24, cutoff, opAsg, opCmp);
+    }
+
+    void radixSortMSD(float* values, const int n, Operation* opAsg, Operation* opCmp, const int cutoff)
+    {
+        radix_msd<float, FloatKey>(values, n, 24, cutoff, opAsg, opCmp);
+    }
+
+    TEST_CASE("Radix sort")
+    {
+        const int sizes[] = {0, 1, 2, 31, 33, 1000, 100000};
+        const int digits[] = {1, 8, 11, 16};
+        std::vector<int> values, data, expected;
+        for (int n : sizes) {
+            values.resize(n);
+            // full range with negatives, few distinct values, the extremes and already sorted inputs
+            for (int input = 0; input < 4; input++) {
+                if (n > 1) {
+                    if (input == 0) {
+                        FillRandomArray(values.data(), n, -1000000000, 1000000000);
+                    } else if (input == 1) {
+                        FillRandomArray(values.data(), n, -3, 3);
+                    } else if (input == 2) {
+                        for (int i = 0; i < n; i++) {
+                            values[i] = i % 3 == 0 ? std::numeric_limits<int>::min()
+                                      : i % 3 == 1 ? std::numeric_limits<int>::max() : 0;
+                        }
+                    } else {
+                        FillRandomArray(values.data(), n, -1000000000, 1000000000, false, DESCENDING);
+                    }
+                }
+                expected = values;
+                std::sort(expected.begin(), expected.end());
+                for (int bits : digits) {
+                    data = values;
+                    radixSortLSD(data.data(), n, nullptr, nullptr, bits);
+                    REQUIRE( data == expected );
+                }
+                const int cutoffs[] = {0, RADIX_MSD_CUTOFF, 1000};
+                for (int cutoff : cutoffs) {
+                    data = values;
+                    radixSortMSD(data.data(), n, nullptr, nullptr, cutoff);
+                    REQUIRE( data == expected );
+                }
+            }
+        }
+
+        // floats: both signs, both zeros and the infinities
+        std::vector<float> floats(10000), floatData, floatExpected;
+        FillRandomArray(floats.data(), (int)floats.size(), -1e6f, 1e6f);
+        floats[0] = 0.0f;
+        floats[1] = -0.0f;
+        floats[2] = std::numeric_limits<float>::infinity();
+        floats[3] = -std::numeric_limits<float>::infinity();
+        floats[4] = std::numeric_limits<float>::denorm_min();
+        floats[5] = -std::numeric_limits<float>::denorm_min();
+        floatExpected = floats;
+        std::sort(floatExpected.begin(), floatExpected.end());
+        for (int bits : digits) {
+            floatData = floats;
+            radixSortLSD(floatData.data(), (int)floatData.size(), nullptr, nullptr, bits);
+            REQUIRE( floatData == floatExpected );
+        }
+        floatData = floats;
+        radixSortMSD(floatData.data(), (int)floatData.size());
+        REQUIRE( floatData == floatExpected );
+        // -0 before +0, which the comparison based sort leaves in any order
+        const size_t zero = std::lower_bound(floatData.begin(), floatData.end(), 0.0f) - floatData.begin();
+        REQUIRE( std::signbit(floatData[zero]) );
+        REQUIRE( !std::signbit(floatData[zero + 1]) );
+
+        // LSD moves every value once per pass and does not compare
+        Profiler p("radix");
+        Operation asg = p.createOperation("asg", 100000);
+        Operation cmp = p.createOperation("cmp", 100000);
+        FillRandomArray(values.data(), 100000, -1000000000, 1000000000);
+        radixSortLSD(values.data(), 100000, &asg, &cmp, 8);
+        REQUIRE( asg.get() == 4 * 100000 );
+        REQUIRE( cmp.get() == 0 );
+    }
+
+    namespace
+    {
+        // times the sort of n values, repeated up to 10^6 values for the small sizes, and returns the ns per
+        // element; every repetition sorts other values, the branch predictor would learn a repeated input
+        template <typename T, typename Sort>
+        double timeSort(Profiler& profiler, const char* name, const std::vector<T>& values, std::vector<T>& data,
+                        const int n, Sort sort)
+        {
+            const int reps = std::max(1, 1000000 / n);
+            profiler.startTimer(name, n);
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < reps; i++) {
+                const size_t from = (size_t)i * n + n <= values.size() ? (size_t)i * n : 0;
+                std::copy(values.begin() + from, values.begin() + from + n, data.begin());
+                sort(data.data(), n);
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            profiler.stopTimer(name, n);
+            return elapsed.count() * 1e9 / ((double)n * reps);
+        }
+    }
+
+    void benchmarkRadix(Profiler& profiler, const int maxSize)
+    {
+        printf("Sorting random ints in [-10^9, 10^9] and floats in [-10^6, 10^6], ns per element\n");
+        std::vector<int> values(std::max(maxSize, 1000000)), data(maxSize);
+        std::vector<float> floats(values.size()), floatData(maxSize);
+        FillRandomArray(values.data(), (int)values.size(), -1000000000, 1000000000);
+        FillRandomArray(floats.data(), (int)floats.size(), -1e6f, 1e6f);
+        for (long long size = 1000; size <= maxSize; size *= 10) {
+            const int n = (int)size;
+
+            const double quick = timeSort(profiler, "quickSort", values, data, n, [](int* v, int m) {
+                quickSort(v, m);
+            });
+            const double hybrid = timeSort(profiler, "hybridizedQuickSort", values, data, n, [](int* v, int m) {
+                hybridizedQuickSort(v, m);
+            });
+            const double stdSort = timeSort(profiler, "stdSort", values, data, n, [](int* v, int m) {
+                std::sort(v, v + m);
+            });
+            const double lsd8 = timeSort(profiler, "lsd8", values, data, n, [](int* v, int m) {
+                radixSortLSD(v, m, nullptr, nullptr, 8);
+            });
+            const double lsd11 = timeSort(profiler, "lsd11", values, data, n, [](int* v, int m) {
+                radixSortLSD(v, m, nullptr, nullptr, 11);
+            });
+            const double lsd16 = timeSort(profiler, "lsd16", values, data, n, [](int* v, int m) {
+                radixSortLSD(v, m, nullptr, nullptr, 16);
+            });
+            const double msd = timeSort(profiler, "msd", values, data, n, [](int* v, int m) {
+                radixSortMSD(v, m);
+            });
+            const double floatStd = timeSort(profiler, "stdSortFloat", floats, floatData, n, [](float* v, int m) {
+                std::sort(v, v + m);
+            });
+            const double floatLsd = timeSort(profiler, "lsd11Float", floats, floatData, n, [](float* v, int m) {
+                radixSortLSD(v, m, nullptr, nullptr, 11);
+            });
+            const double floatMsd = timeSort(profiler, "msdFloat", floats, floatData, n, [](float* v, int m) {
+                radixSortMSD(v, m);
+            });
+            printf("n(%d): quick %.1f, hybrid %.1f, std::sort %.1f, LSD 8/11/16 bits %.1f / %.1f / %.1f, MSD %.1f; "
+                   "floats: std::sort %.1f, LSD 11 bits %.1f, MSD %.1f\n", n, quick, hybrid, stdSort, lsd8, lsd11,
+                   lsd16, msd, floatStd, floatLsd, floatMsd);
+        }
+        profiler.createGroup("Sorting ints", "quickSort", "hybridizedQuickSort", "stdSort", "lsd8", "lsd11", "lsd16",
+                             "msd");
+        profiler.createGroup("Sorting floats", "stdSortFloat", "lsd11Float", "msdFloat");
+        profiler.showReport();
+    }
+
+} // namespace lab03
@@ -0,0 +1,74 @@
+#ifndef __RADIX_SORT_H__
+#define __RADIX_SORT_H__
+
+#include "Profiler.h"
+#include "commandline.h"
+
+namespace lab03
+{
+
+	/**
+	 * @brief Buckets of up to this size are finished by insertion sort in radixSortMSD
+	 */
+	constexpr int RADIX_MSD_CUTOFF = 32;
+
+	/**
+	 * @brief Least significant digit first radix sort of 32-bit keys
+	 *
+	 * Every pass distributes the values by one digit of digitBits bits into a buffer of n values, stably, so after
+	 * the pass of the highest digit the values are sorted: ceil(32 / digitBits) passes, O(n) extra memory and no
+	 * comparison at all. The histograms of all the digits are counted in a single read of the input, and a pass
+	 * whose digit is the same for every value is skipped. The keys are the values with the sign bit flipped, which
+	 * orders the negative ints before the positive ones.
+	 *
+	 * @param values array of input values to be sorted
+	 * @param n number of values in the input array
+	 * @param opAsg optional counter for assignment operations
+	 * @param opCmp optional counter for comparison operations (LSD does none)
+	 * @param digitBits bits per digit, from 1 to 16: 8 (4 passes), 11 (3 passes) or 16 (2 passes)
+	 */
+	void radixSortLSD(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr, int digitBits = 8);
+
+	/**
+	 * @brief radixSortLSD of floats
+	 *
+	 * The keys are the bits of the floats with the sign bit flipped for the positive ones and all the bits flipped
+	 * for the negative ones, whose bits order them backwards: -inf < ... < -0 < +0 < ... < +inf, and NaNs with the
+	 * sign bit clear at the end.
+	 */
+	void radixSortLSD(float* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr, int digitBits = 8);
+
+	/**
+	 * @brief Most significant digit first radix sort of 32-bit keys, in place
+	 *
+	 * The values are distributed by their highest 8-bit digit into 256 buckets by swapping them into place
+	 * (American flag sort, no buffer), then every bucket is sorted by the next digit. Buckets of up to cutoff
+	 * values are finished by insertion sort, so the small buckets near the leaves do not pay for 256 counters.
+	 * The keys are the same as in radixSortLSD.
+	 *
+	 * @param values array of input values to be sorted
+	 * @param n number of values in the input array
+	 * @param opAsg optional counter for assignment operations
+	 * @param opCmp optional counter for comparison operations (only made by insertion sort)
+	 * @param cutoff largest bucket sorted by insertion sort
+	 */
+	void radixSortMSD(int* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr,
+	                  int cutoff = RADIX_MSD_CUTOFF);
+
+	/**
+	 * @brief radixSortMSD of floats, ordered like in radixSortLSD
+	 */
+	void radixSortMSD(float* values, int n, Operation* opAsg = nullptr, Operation* opCmp = nullptr,
+	                  int cutoff = RADIX_MSD_CUTOFF);
+
+	/**
+	 * @brief Benchmarking of the radix sorts against quickSort, hybridizedQuickSort and std::sort
+	 *
+	 * @param profiler profiler to use
+	 * @param maxSize largest number of values, the sizes are the powers of 10 from 10^3 up to it
+	 */
+	void benchmarkRadix(Profiler& profiler, int maxSize);
+
+} // namespace lab03
+
+#endif // __RADIX_SORT_H__
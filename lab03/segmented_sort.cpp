@@ -0,0 +1,260 @@
+#include "segmented_sort.h"
+#include "quick_sort.h"
+
+#include "catch2.hpp"
+#include "cpu_features.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/*
+ * ---------- SEGMENTED SORT ----------
+ * Sorting millions of arrays of 8-64 elements one by one pays the call, the recursion and the threshold check of
+ * hybridized quicksort every time, and insertion sort on such sizes is dominated by mispredicted branches.
+ * Segments of the same length are therefore sorted 8 at a time: element j of 8 segments is transposed into one AVX2
+ * register and Batcher's odd-even merge sorting network is run on the registers with min/max instructions.
+ * The network is branch free and its comparators are the same for every lane, so one pass sorts 8 segments.
+ * Blocks of segments are handed out to the worker threads through an atomic counter.
+ * With segments of 8-64 random elements a single thread goes from ~0.75M segments/s (hybridized quicksort called
+ * on every segment) to ~3.5-4M segments/s with the AVX2 networks, the threads scale that further with the cores.
+ */
+
+namespace lab03
+{
+    struct NetworkPair {
+        unsigned char lo, hi;
+    };
+
+    // Batcher's odd-even merge sort networks for every length up to MAX_NETWORK_SEGMENT, comparators that
+    // would touch positions past the length are dropped, which is the same as padding with +infinity
+    struct SortingNetworks {
+        std::vector<NetworkPair> pairs[MAX_NETWORK_SEGMENT + 1];
+
+        SortingNetworks() {
+            for (int n = 2; n <= MAX_NETWORK_SEGMENT; n++) {
+                for (int p = 1; p < n; p <<= 1) {
+                    for (int k = p; k >= 1; k >>= 1) {
+                        for (int j = k % p; j + k < n; j += 2 * k) {
+                            for (int i = 0; i < k && i + j + k < n; i++) {
+                                if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+                                    const NetworkPair pair = {(unsigned char)(i + j), (unsigned char)(i + j + k)};
+                                    pairs[n].push_back(pair);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    const std::vector<NetworkPair>& sortingNetwork(const int n) {
+        static const SortingNetworks networks; // initialization is thread safe
+        return networks.pairs[n];
+    }
+
+#ifdef HAS_X86_SIMD
+    // sorts the 8 segments of the given length starting at values + starts[lane], one segment per lane
+    TARGET_AVX2 void sortBatchAvx2(int* values, const int* starts, const int length, const std::vector<NetworkPair>& network) {
+        alignas(32) int columns[MAX_NETWORK_SEGMENT][8];
+        for (int lane = 0; lane < 8; lane++) {
+            const int* segment = values + starts[lane];
+            for (int j = 0; j < length; j++) {
+                columns[j][lane] = segment[j];
+            }
+        }
+
+        for (const NetworkPair& pair : network) {
+            __m256i* lo = reinterpret_cast<__m256i*>(columns[pair.lo]);
+            __m256i* hi = reinterpret_cast<__m256i*>(columns[pair.hi]);
+            const __m256i a = _mm256_load_si256(lo);
+            const __m256i b = _mm256_load_si256(hi);
+            _mm256_store_si256(lo, _mm256_min_epi32(a, b));
+            _mm256_store_si256(hi, _mm256_max_epi32(a, b));
+        }
+
+        for (int lane = 0; lane < 8; lane++) {
+            int* segment = values + starts[lane];
+            for (int j = 0; j < length; j++) {
+                segment[j] = columns[j][lane];
+            }
+        }
+    }
+#endif
+
+    // sorts the segments [first, last), grouping the short ones by length so they can go through the network together
+    void sortSegmentRange(int* values, const int* offsets, const int first, const int last, const bool simd,
+                          std::vector<int>* buckets) {
+        for (int length = 0; length <= MAX_NETWORK_SEGMENT; length++) {
+            buckets[length].clear();
+        }
+
+        for (int s = first; s < last; s++) {
+            const int length = offsets[s + 1] - offsets[s];
+            if (length > MAX_NETWORK_SEGMENT) {
+                hybridizedQuickSort(values + offsets[s], length);
+            } else if (length > 1) {
+                buckets[length].push_back(offsets[s]);
+            }
+        }
+
+        for (int length = 2; length <= MAX_NETWORK_SEGMENT; length++) {
+            const std::vector<int>& starts = buckets[length];
+            size_t i = 0;
+#ifdef HAS_X86_SIMD
+            if (simd) {
+                const std::vector<NetworkPair>& network = sortingNetwork(length);
+                for (; i + 8 <= starts.size(); i += 8) {
+                    sortBatchAvx2(values, &starts[i], length, network);
+                }
+            }
+#endif
+            for (; i < starts.size(); i++) { // what is left over from the batches of 8
+                hybridizedQuickSort(values + starts[i], length);
+            }
+        }
+    }
+
+    void segmentedSort(int* values, const int* offsets, const int segments, int threads, bool simd)
+    {
+        constexpr int block = 4096; // segments handed out to a worker at once
+        simd = simd && cpuSupportsAvx2();
+        if (simd) {
+            sortingNetwork(2); // build the networks before the workers start
+        }
+
+        if (threads <= 0) {
+            threads = std::max(1, (int)std::thread::hardware_concurrency());
+        }
+        threads = std::max(1, std::min(threads, (segments + block - 1) / block));
+
+        std::atomic<int> next(0);
+        const auto worker = [&]() {
+            std::vector<int> buckets[MAX_NETWORK_SEGMENT + 1];
+            int first;
+            while ((first = next.fetch_add(block)) < segments) {
+                sortSegmentRange(values, offsets, first, std::min(first + block, segments), simd, buckets);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; t++) {
+            workers.emplace_back(worker);
+        }
+        worker(); // the calling thread works as well
+        for (std::thread& w : workers) {
+            w.join();
+        }
+    }
+
+    // fills offsets for the given number of segments with random lengths in [min_length, max_length]
+    int generateSegments(std::vector<int>& offsets, const int segments, const int min_length, const int max_length) {
+        offsets.resize(segments + 1);
+        offsets[0] = 0;
+        for (int s = 0; s < segments; s++) {
+            offsets[s + 1] = offsets[s] + min_length + rand() % (max_length - min_length + 1);
+        }
+        return offsets[segments];
+    }
+
+    TEST_CASE("Segmented sort")
+    {
+        std::vector<int> offsets;
+        const int total = generateSegments(offsets, 20000, 0, 100);
+        std::vector<int> values(total), expected;
+        FillRandomArray(values.data(), total);
+
+        expected = values;
+        for (int s = 0; s < 20000; s++) {
+            std::sort(expected.begin() + offsets[s], expected.begin() + offsets[s + 1]);
+        }
+
+        const int threads[] = {1, 4};
+        const bool simd[] = {false, true};
+        for (int t : threads) {
+            for (bool vectorized : simd) {
+                std::vector<int> data(values);
+                segmentedSort(data.data(), offsets.data(), 20000, t, vectorized);
+                REQUIRE( data == expected );
+            }
+        }
+    }
+
+    TEST_CASE("Sorting networks")
+    {
+        // every network length on many random inputs with duplicates
+        for (int n = 2; n <= MAX_NETWORK_SEGMENT; n++) {
+            for (int rep = 0; rep < 50; rep++) {
+                int data[MAX_NETWORK_SEGMENT];
+                FillRandomArray(data, n, 1, 10);
+                for (const NetworkPair& pair : sortingNetwork(n)) {
+                    if (data[pair.hi] < data[pair.lo]) {
+                        std::swap(data[pair.lo], data[pair.hi]);
+                    }
+                }
+                REQUIRE( IsSorted(data, n) );
+            }
+        }
+    }
+
+    void benchmarkSegments(Profiler& profiler)
+    {
+        printf("Sorting segments of 8-64 elements, times for 10 runs\n");
+        const int hardware_threads = std::max(1, (int)std::thread::hardware_concurrency());
+        std::vector<int> offsets, values, data;
+        for (int segments = 50000; segments <= 500000; segments += 50000) {
+            const int total = generateSegments(offsets, segments, 8, 64);
+            values.resize(total);
+            FillRandomArray(values.data(), total);
+            printf("segments(%d): ", segments);
+
+            profiler.startTimer("perSegment", segments);
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < 10; i++) {
+                data = values;
+                for (int s = 0; s < segments; s++) {
+                    hybridizedQuickSort(data.data() + offsets[s], offsets[s + 1] - offsets[s]);
+                }
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            profiler.stopTimer("perSegment", segments);
+            printf("per segment %.2fM/s, ", 10 * segments / elapsed.count() / 1e6);
+
+            profiler.startTimer("segmentedScalar", segments);
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < 10; i++) {
+                data = values;
+                segmentedSort(data.data(), offsets.data(), segments, 1, false);
+            }
+            elapsed = std::chrono::steady_clock::now() - start;
+            profiler.stopTimer("segmentedScalar", segments);
+            printf("scalar %.2fM/s, ", 10 * segments / elapsed.count() / 1e6);
+
+            profiler.startTimer("segmentedSimd", segments);
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < 10; i++) {
+                data = values;
+                segmentedSort(data.data(), offsets.data(), segments, 1, true);
+            }
+            elapsed = std::chrono::steady_clock::now() - start;
+            profiler.stopTimer("segmentedSimd", segments);
+            printf("simd %.2fM/s, ", 10 * segments / elapsed.count() / 1e6);
+
+            profiler.startTimer("segmentedSimdThreads", segments);
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < 10; i++) {
+                data = values;
+                segmentedSort(data.data(), offsets.data(), segments, hardware_threads, true);
+            }
+            elapsed = std::chrono::steady_clock::now() - start;
+            profiler.stopTimer("segmentedSimdThreads", segments);
+            printf("simd with %d threads %.2fM/s segments\n", hardware_threads, 10 * segments / elapsed.count() / 1e6);
+        }
+        profiler.createGroup("Segmented sort", "perSegment", "segmentedScalar", "segmentedSimd", "segmentedSimdThreads");
+        profiler.showReport();
+    }
+
+} // namespace lab03
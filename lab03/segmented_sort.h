@@ -0,0 +1,39 @@
+#ifndef __SEGMENTED_SORT_H__
+#define __SEGMENTED_SORT_H__
+
+#include "Profiler.h"
+#include "commandline.h"
+
+namespace lab03
+{
+
+	/**
+	 * @brief Longest segment that is sorted with a sorting network, longer ones fall back to hybridized quick sort
+	 */
+	constexpr int MAX_NETWORK_SEGMENT = 64;
+
+	/**
+	 * @brief Sorts many independent segments of one flat buffer in place
+	 *
+	 * Segment i is values[offsets[i], offsets[i + 1]). Segments of the same length are batched 8 at a time
+	 * into an AVX2 sorting network (one segment per vector lane), the rest is sorted by hybridized quick sort.
+	 * Segments are spread across worker threads.
+	 *
+	 * @param values flat buffer holding all the segments
+	 * @param offsets segments + 1 ascending offsets into values
+	 * @param segments number of segments
+	 * @param threads number of worker threads, 0 uses every hardware thread
+	 * @param simd use the vectorized kernel when the CPU supports AVX2
+	 */
+	void segmentedSort(int* values, const int* offsets, int segments, int threads = 0, bool simd = true);
+
+	/**
+	 * @brief Throughput benchmark (segments / second) of segmentedSort against sorting every segment separately
+	 *
+	 * @param profiler profiler to use
+	 */
+	void benchmarkSegments(Profiler& profiler);
+
+} // namespace lab03
+
+#endif // __SEGMENTED_SORT_H__
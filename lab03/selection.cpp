@@ -0,0 +1,485 @@
+#include "selection.h"
+#include "quick_sort.h"
+
+#include "catch2.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/*
+ * ---------- LINEAR TIME SELECTION ----------
+ * quickSelect pivots on the last element, so an ascending array is partitioned into n - 1 and 0 elements at every
+ * step: O(n^2). nthElement keeps the block partitions of quickSelect but chooses better pivots and watches its
+ * progress: when three partitions in a row did not halve the range, Floyd-Rivest hands the rest to introselect and
+ * introselect to median of medians, which is O(n) whatever the input, so no input makes any of them quadratic.
+ * (With a window of two partitions introselect gave up too often: up to 7.7n comparisons instead of at most 3.9n.)
+ * Floyd-Rivest first selects the k-th element of a sample of ~n^(2/3) / 2 elements around k. With that pivot the
+ * side that holds k is a range of O(n^(2/3)) elements in almost every call, so the selection costs little more
+ * than one partition of the array. Comparisons for the k-th of 10^6 random ints (30 runs, k = n / 100, n / 2 and
+ * 0.999n): Floyd-Rivest 1.25n on average, introselect 2.1n, median of medians ~10.9n (7.6n on an ascending array).
+ * bench_select, the median of 10^5 ... 10^6 ints, 5 runs per size, total ms:
+ *     random: Floyd-Rivest 78, introselect 115, median of medians 1513-1587, std::nth_element 375, quickSelect 167
+ *     ascending: 40-46, 35-40, 598-610, 56-63 (quickSelect is quadratic)
+ *     100 distinct values: 80, 102-134, 553-606, 292-312, 179-241
+ * The block partitions without mispredictions make up for most of the lead over std::nth_element, the sampling for
+ * the rest. The sample is taken from the elements around k, which only represents the range when it is not made of
+ * sorted runs: on the buffers of TopK (k kept values followed by k smaller descending ones) Floyd-Rivest stalls and
+ * needs ~3.6n comparisons, so TopK keeps std::nth_element.
+ *
+ * ---------- MULTI-SELECT ----------
+ * p50, p90, p99 and p999 with four selections cost four passes over most of the array: the second one starts on
+ * the n / 2 elements right of the median, and so on. multiSelect selects the middle rank first and searches for the
+ * others only on their side of it, so the n / 2 elements left of the median are never looked at again.
+ * bench_multiselect, 10^5 ... 10^6 random ints, 5 runs per size, total ms: multiSelect 142-154, four nthElement
+ * calls on the same array 456-489, four quickSelects 451-765, introSort of the whole array 1739-1938. The repeated
+ * nthElement calls are slower than expected because the array left by the previous call is made of partitioned
+ * runs, which the samples of Floyd-Rivest do not represent (see above).
+ * partialSort is nthElement followed by introSort of the k - 1 elements before the k-th: the 1000 smallest take
+ * 36-40 ms against 49-51 ms for std::partial_sort, which keeps a heap of k elements.
+ */
+
+namespace lab03
+{
+    namespace
+    {
+        void swapValues(int* values, const int a, const int b, Operation* opAsg)
+        {
+            std::swap(values[a], values[b]);
+            if (opAsg) opAsg->count(3);
+        }
+
+        // continues on the side of the partition that holds k, true once k is in its final place
+        bool narrow(int& l, int& r, const int k, const int lt, const int gt)
+        {
+            if (k < lt) {
+                r = lt - 1;
+                return false;
+            }
+            if (k > gt) {
+                l = gt + 1;
+                return false;
+            }
+            return true;
+        }
+
+        // every three partitions the range has to be at most half of what it was before them
+        class Progress
+        {
+        public:
+            explicit Progress(const int n) : checkpoint(n), partitions(0) {}
+
+            // called before every partition with the size of the range, false once the selection stalls
+            bool ok(const int size)
+            {
+                if (partitions == 3) {
+                    if (2 * size > checkpoint) {
+                        return false;
+                    }
+                    checkpoint = size;
+                    partitions = 0;
+                }
+                partitions++;
+                return true;
+            }
+
+        private:
+            int checkpoint;
+            int partitions;
+        };
+
+        void medianOfMedians(int* values, int l, int r, const int k, Operation* opAsg, Operation* opCmp)
+        {
+            for (;;) {
+                const int n = r - l + 1;
+                if (n <= SELECT_INSERTION_SIZE) {
+                    insertionSort(values + l, n, opAsg, opCmp);
+                    return;
+                }
+
+                // the medians of the groups of 5 are gathered at the front of the range, the median of those is
+                // not smaller than 3 elements of half of the groups and not greater than 3 of the other half
+                const int groups = n / 5;
+                for (int g = 0; g < groups; g++) {
+                    insertionSort(values + l + 5 * g, 5, opAsg, opCmp);
+                    swapValues(values, l + g, l + 5 * g + 2, opAsg);
+                }
+                const int mid = l + groups / 2;
+                medianOfMedians(values, l, l + groups - 1, mid, opAsg, opCmp);
+
+                // the copies of the pivot are left out, so the guarantee holds with duplicates too
+                swapValues(values, mid, r, opAsg);
+                int lt, gt;
+                partitionRange(values, l, r, lt, gt, THREE_WAY, opAsg, opCmp);
+                if (narrow(l, r, k, lt, gt)) {
+                    return;
+                }
+            }
+        }
+
+        void introSelect(int* values, int l, int r, const int k, Operation* opAsg, Operation* opCmp)
+        {
+            Progress progress(r - l + 1);
+            for (;;) {
+                const int n = r - l + 1;
+                if (n <= SELECT_INSERTION_SIZE) {
+                    insertionSort(values + l, n, opAsg, opCmp);
+                    return;
+                }
+                if (!progress.ok(n)) {
+                    medianOfMedians(values, l, r, k, opAsg, opCmp);
+                    return;
+                }
+
+                int lt, gt;
+                pivotPartition(values, l, r, lt, gt, BLOCK, opAsg, opCmp);
+                if (narrow(l, r, k, lt, gt)) {
+                    return;
+                }
+            }
+        }
+
+        void floydRivest(int* values, int l, int r, const int k, Operation* opAsg, Operation* opCmp)
+        {
+            Progress progress(r - l + 1);
+            for (;;) {
+                const int n = r - l + 1;
+                if (n <= SELECT_INSERTION_SIZE) {
+                    insertionSort(values + l, n, opAsg, opCmp);
+                    return;
+                }
+                if (!progress.ok(n)) {
+                    // the samples do not represent the range (runs of sorted values), the ninther copes better
+                    // with those and falls back to median of medians in turn
+                    introSelect(values, l, r, k, opAsg, opCmp);
+                    return;
+                }
+
+                int lt, gt;
+                if (n > FLOYD_RIVEST_SIZE) {
+                    // the sample holds the elements around k, (k - l) / n of its s elements go to the left of
+                    // values[k] once it is selected; the bounds are shifted by a few standard deviations towards
+                    // the middle of the range so that the estimate errs on the side of the smaller partition
+                    const double i = k - l + 1;
+                    const double z = std::log((double)n);
+                    const double s = 0.5 * std::exp(2 * z / 3);
+                    const double sd = 0.5 * std::sqrt(z * s * (n - s) / n) * (i < n / 2.0 ? -1 : 1);
+                    const int sampleL = std::max(l, (int)(k - i * s / n + sd));
+                    const int sampleR = std::min(r, (int)(k + (n - i) * s / n + sd));
+                    floydRivest(values, sampleL, sampleR, k, opAsg, opCmp);
+
+                    swapValues(values, k, r, opAsg);
+                    partitionRange(values, l, r, lt, gt, BLOCK, opAsg, opCmp);
+                } else {
+                    pivotPartition(values, l, r, lt, gt, BLOCK, opAsg, opCmp);
+                }
+                if (narrow(l, r, k, lt, gt)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    void nthElement(int* values, const int n, const int k, Operation* opAsg, Operation* opCmp,
+                    const SelectAlgorithm algorithm)
+    {
+        if (k < 0 || k >= n) {
+            return;
+        }
+        switch (algorithm) {
+        case MEDIAN_OF_MEDIANS:
+            medianOfMedians(values, 0, n - 1, k, opAsg, opCmp);
+            break;
+        case INTROSELECT:
+            introSelect(values, 0, n - 1, k, opAsg, opCmp);
+            break;
+        default:
+            floydRivest(values, 0, n - 1, k, opAsg, opCmp);
+            break;
+        }
+    }
+
+    namespace
+    {
+        void multi_select(int* values, const int l, const int r, const int* ranks, const int count, Operation* opAsg,
+                          Operation* opCmp)
+        {
+            if (count == 0) {
+                return;
+            }
+            // the middle rank splits the array, the ranks before it are in values[l, k) and the ones after it in
+            // values(k, r], so each half of the ranks only searches its side
+            const int k = ranks[count / 2];
+            floydRivest(values, l, r, k, opAsg, opCmp);
+            const int* first = std::lower_bound(ranks, ranks + count, k);
+            const int* last = std::upper_bound(ranks, ranks + count, k);
+            multi_select(values, l, k - 1, ranks, (int)(first - ranks), opAsg, opCmp);
+            multi_select(values, k + 1, r, last, (int)(ranks + count - last), opAsg, opCmp);
+        }
+    }
+
+    void multiSelect(int* values, const int n, const int* ranks, const int count, Operation* opAsg,
+                     Operation* opCmp)
+    {
+        // ranks outside [0, n) are ignored
+        const int* first = std::lower_bound(ranks, ranks + count, 0);
+        const int* last = std::lower_bound(first, ranks + count, n);
+        multi_select(values, 0, n - 1, first, (int)(last - first), opAsg, opCmp);
+    }
+
+    void partialSort(int* values, const int n, int k, Operation* opAsg, Operation* opCmp)
+    {
+        k = std::max(0, std::min(k, n));
+        if (k == 0) {
+            return;
+        }
+        nthElement(values, n, k - 1, opAsg, opCmp);
+        introSort(values, k - 1, opAsg, opCmp, TUNED_THRESHOLD, BLOCK);
+    }
+
+    TEST_CASE("Linear time selection")
+    {
+        const SelectAlgorithm algorithms[] = {FLOYD_RIVEST, INTROSELECT, MEDIAN_OF_MEDIANS};
+        const int sizes[] = {1, 2, 5, 17, 1000, 100000};
+        std::vector<int> values, data, expected;
+        for (int n : sizes) {
+            // random, few distinct, ascending, descending, all equal and organ pipe inputs
+            std::vector<std::vector<int>> inputs;
+            values.resize(n);
+            FillRandomArray(values.data(), n, 0, 1000000);
+            inputs.push_back(values);
+            FillRandomArray(values.data(), n, 0, 3);
+            inputs.push_back(values);
+            FillRandomArray(values.data(), n, 0, 1000000, false, ASCENDING);
+            inputs.push_back(values);
+            FillRandomArray(values.data(), n, 0, 1000000, false, DESCENDING);
+            inputs.push_back(values);
+            inputs.push_back(std::vector<int>(n, 7));
+            for (int i = 0; i < n; i++) {
+                values[i] = i < n / 2 ? i : n - i;
+            }
+            inputs.push_back(values);
+
+            const int ks[] = {0, n / 100, n / 2, n - 1 - n / 1000, n - 1};
+            for (const std::vector<int>& input : inputs) {
+                expected = input;
+                std::sort(expected.begin(), expected.end());
+                for (SelectAlgorithm algorithm : algorithms) {
+                    for (int k : ks) {
+                        data = input;
+                        nthElement(data.data(), n, k, nullptr, nullptr, algorithm);
+                        REQUIRE( data[k] == expected[k] );
+                        REQUIRE( *std::max_element(data.begin(), data.begin() + k + 1) == data[k] );
+                        REQUIRE( *std::min_element(data.begin() + k, data.end()) == data[k] );
+                        std::sort(data.begin(), data.end());
+                        REQUIRE( data == expected );
+                    }
+                }
+            }
+        }
+
+        // out of range ranks leave the array alone
+        data = {3, 1, 2};
+        nthElement(data.data(), 3, 3);
+        nthElement(data.data(), 3, -1);
+        REQUIRE( data == std::vector<int>({3, 1, 2}) );
+
+        // a linear number of comparisons on the worst input of quickSelect, with every algorithm
+        constexpr int size = 100000;
+        Profiler p("selection");
+        for (SelectAlgorithm algorithm : algorithms) {
+            Operation asg = p.createOperation("asg", algorithm);
+            Operation cmp = p.createOperation("cmp", algorithm);
+            FillRandomArray(values.data(), size, 0, 1000000, false, ASCENDING);
+            nthElement(values.data(), size, 0, &asg, &cmp, algorithm);
+            REQUIRE( cmp.get() < 30 * size );
+        }
+    }
+
+    TEST_CASE("Multi-select")
+    {
+        constexpr int size = 100000;
+        std::vector<int> values(size), data, expected;
+        const int ranges[] = {10, size, 1000000000};
+        for (int range : ranges) {
+            FillRandomArray(values.data(), size, 0, range);
+            expected = values;
+            std::sort(expected.begin(), expected.end());
+
+            // percentiles, the ends, a dense run of ranks, duplicates and out of range ranks
+            const std::vector<std::vector<int>> rankSets = {
+                {size / 2, size * 9 / 10, size * 99 / 100, size * 999 / 1000},
+                {0, size - 1},
+                {5, 6, 7, 8, 9, 10, 11, 500, 501, 502},
+                {100, 100, 100, 7000},
+                {-5, 3, 40000, size, size + 10},
+                {},
+            };
+            for (const std::vector<int>& ranks : rankSets) {
+                data = values;
+                multiSelect(data.data(), size, ranks.data(), (int)ranks.size());
+                int previous = -1;
+                for (int k : ranks) {
+                    if (k < 0 || k >= size) {
+                        continue;
+                    }
+                    REQUIRE( data[k] == expected[k] );
+                    // everything between two ranks lies between their values
+                    const int from = std::max(previous, 0);
+                    if (previous >= 0) {
+                        REQUIRE( *std::min_element(data.begin() + from, data.begin() + k + 1) == data[from] );
+                    }
+                    REQUIRE( *std::max_element(data.begin() + from, data.begin() + k + 1) == data[k] );
+                    previous = k;
+                }
+                if (previous >= 0) {
+                    REQUIRE( *std::min_element(data.begin() + previous, data.end()) == data[previous] );
+                }
+                std::sort(data.begin(), data.end());
+                REQUIRE( data == expected );
+            }
+
+            // the k smallest, sorted
+            const int ks[] = {-1, 0, 1, 17, 1000, size - 1, size, size + 1};
+            for (int k : ks) {
+                data = values;
+                partialSort(data.data(), size, k);
+                const int sorted = std::max(0, std::min(k, size));
+                REQUIRE( std::equal(data.begin(), data.begin() + sorted, expected.begin()) );
+                if (sorted > 0 && sorted < size) {
+                    REQUIRE( *std::min_element(data.begin() + sorted, data.end()) >= data[sorted - 1] );
+                }
+            }
+        }
+
+        // the ranks share the partitions: fewer comparisons than selecting each one in a fresh copy
+        Profiler p("multi-select");
+        Operation multiCmp = p.createOperation("multiCmp", size);
+        Operation singleCmp = p.createOperation("singleCmp", size);
+        FillRandomArray(values.data(), size, 0, 1000000000);
+        const int percentiles[] = {size / 2, size * 9 / 10, size * 99 / 100, size * 999 / 1000};
+        data = values;
+        multiSelect(data.data(), size, percentiles, 4, nullptr, &multiCmp);
+        for (int k : percentiles) {
+            data = values;
+            nthElement(data.data(), size, k, nullptr, &singleCmp);
+        }
+        REQUIRE( multiCmp.get() < singleCmp.get() );
+    }
+
+    void benchmarkSelection(Profiler& profiler)
+    {
+        printf("Comparing the selection algorithms on the median of 10^5 - 10^6 ints, times for 5 runs\n");
+        const char* inputNames[] = {"Random", "Ascending", "FewDistinct"};
+        const char* algorithmNames[] = {"FloydRivest", "Introselect", "MedianOfMedians", "StdNthElement",
+                                        "QuickSelect"};
+        constexpr int max_size = 1000000;
+        std::vector<int> values(max_size), data(max_size);
+        char names[3][5][64];
+        for (int input = 0; input < 3; input++) {
+            for (int a = 0; a < 5; a++) {
+                snprintf(names[input][a], sizeof(names[input][a]), "%s%s", algorithmNames[a], inputNames[input]);
+            }
+        }
+
+        for (int n = 100000; n <= max_size; n += 100000) {
+            printf("n(%d)\n", n);
+            for (int input = 0; input < 3; input++) {
+                if (input == 0) {
+                    FillRandomArray(values.data(), n, 0, 1000000000);
+                } else if (input == 1) {
+                    FillRandomArray(values.data(), n, 0, 1000000000, false, ASCENDING);
+                } else {
+                    FillRandomArray(values.data(), n, 0, 100);
+                }
+                // quickSelect is quadratic on the ascending input, it is only timed on the other two
+                for (int a = 0; a < 5; a++) {
+                    if (a == 4 && input == 1) {
+                        continue;
+                    }
+                    profiler.startTimer(names[input][a], n);
+                    for (int i = 0; i < 5; i++) {
+                        std::copy(values.begin(), values.begin() + n, data.begin());
+                        if (a == 3) {
+                            std::nth_element(data.begin(), data.begin() + n / 2, data.begin() + n);
+                        } else if (a == 4) {
+                            quickSelect(data.data(), n, n / 2, nullptr, nullptr, BLOCK);
+                        } else {
+                            nthElement(data.data(), n, n / 2, nullptr, nullptr, (SelectAlgorithm)a);
+                        }
+                    }
+                    profiler.stopTimer(names[input][a], n);
+                }
+            }
+        }
+        profiler.createGroup("Selection, random", names[0][0], names[0][1], names[0][2], names[0][3], names[0][4]);
+        profiler.createGroup("Selection, ascending", names[1][0], names[1][1], names[1][2], names[1][3]);
+        profiler.createGroup("Selection, few distinct", names[2][0], names[2][1], names[2][2], names[2][3],
+                             names[2][4]);
+        profiler.showReport();
+    }
+
+    void benchmarkMultiSelect(Profiler& profiler)
+    {
+        printf("Comparing multiSelect on p50, p90, p99 and p999 with 4 selections and sorting, times for 5 runs\n");
+        constexpr int max_size = 1000000;
+        constexpr int k = 1000;
+        std::vector<int> values(max_size), data(max_size);
+        for (int n = 100000; n <= max_size; n += 100000) {
+            printf("n(%d)\n", n);
+            FillRandomArray(values.data(), n, 0, 1000000000);
+            const int percentiles[] = {n / 2, (int)(n * 0.9), (int)(n * 0.99), (int)(n * 0.999)};
+
+            profiler.startTimer("multiSelect", n);
+            for (int i = 0; i < 5; i++) {
+                std::copy(values.begin(), values.begin() + n, data.begin());
+                multiSelect(data.data(), n, percentiles, 4);
+            }
+            profiler.stopTimer("multiSelect", n);
+
+            // every selection reuses the array left by the previous one
+            profiler.startTimer("nthElementX4", n);
+            for (int i = 0; i < 5; i++) {
+                std::copy(values.begin(), values.begin() + n, data.begin());
+                for (int p : percentiles) {
+                    nthElement(data.data(), n, p);
+                }
+            }
+            profiler.stopTimer("nthElementX4", n);
+
+            profiler.startTimer("quickSelectX4", n);
+            for (int i = 0; i < 5; i++) {
+                std::copy(values.begin(), values.begin() + n, data.begin());
+                for (int p : percentiles) {
+                    quickSelect(data.data(), n, p, nullptr, nullptr, BLOCK);
+                }
+            }
+            profiler.stopTimer("quickSelectX4", n);
+
+            profiler.startTimer("sortAll", n);
+            for (int i = 0; i < 5; i++) {
+                std::copy(values.begin(), values.begin() + n, data.begin());
+                introSort(data.data(), n, nullptr, nullptr, TUNED_THRESHOLD, BLOCK);
+            }
+            profiler.stopTimer("sortAll", n);
+
+            profiler.startTimer("partialSort", n);
+            for (int i = 0; i < 5; i++) {
+                std::copy(values.begin(), values.begin() + n, data.begin());
+                partialSort(data.data(), n, k);
+            }
+            profiler.stopTimer("partialSort", n);
+
+            profiler.startTimer("stdPartialSort", n);
+            for (int i = 0; i < 5; i++) {
+                std::copy(values.begin(), values.begin() + n, data.begin());
+                std::partial_sort(data.begin(), data.begin() + k, data.begin() + n);
+            }
+            profiler.stopTimer("stdPartialSort", n);
+        }
+        profiler.createGroup("Percentiles", "multiSelect", "nthElementX4", "quickSelectX4", "sortAll");
+        profiler.createGroup("The 1000 smallest, sorted", "partialSort", "stdPartialSort");
+        profiler.showReport();
+    }
+
+} // namespace lab03
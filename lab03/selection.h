@@ -0,0 +1,97 @@
+#ifndef __SELECTION_H__
+#define __SELECTION_H__
+
+#include "Profiler.h"
+#include "commandline.h"
+
+namespace lab03
+{
+
+	/**
+	 * @brief How nthElement picks its pivots
+	 *
+	 * FLOYD_RIVEST: the k-th element of a small sample around k is selected first (recursively), the range is then
+	 *               partitioned around it and k almost always ends up in a range of O(n^(2/3)) elements.
+	 * INTROSELECT: median of 3 / ninther pivots, like introSort.
+	 * MEDIAN_OF_MEDIANS: the median of the medians of groups of 5 (Blum, Floyd, Pratt, Rivest and Tarjan), which
+	 *                    always leaves at most 7/10 of the range on the side of k: O(n) in the worst case, but with
+	 *                    a large constant factor.
+	 * A range that did not halve in three partitions is handed on: FLOYD_RIVEST to INTROSELECT, INTROSELECT to
+	 * MEDIAN_OF_MEDIANS, so all three are O(n) whatever the input.
+	 */
+	enum SelectAlgorithm { FLOYD_RIVEST, INTROSELECT, MEDIAN_OF_MEDIANS };
+
+	/**
+	 * @brief Ranges up to this size are finished by insertion sort
+	 */
+	constexpr int SELECT_INSERTION_SIZE = 16;
+
+	/**
+	 * @brief Ranges larger than this are narrowed by Floyd-Rivest sampling before being partitioned
+	 */
+	constexpr int FLOYD_RIVEST_SIZE = 600;
+
+	/**
+	 * @brief Selection with the semantics of std::nth_element
+	 *
+	 * Afterwards values[k] is the element that would be there if the array was sorted, no element before it is
+	 * greater and no element after it is smaller. Nothing is done if k is not in [0, n).
+	 *
+	 * @param values array of input values
+	 * @param n number of values in the input array
+	 * @param k rank of the selected element (0 for the smallest)
+	 * @param opAsg optional counter for assignment operations
+	 * @param opCmp optional counter for comparison operations
+	 * @param algorithm pivot selection
+	 */
+	void nthElement(int* values, int n, int k, Operation* opAsg = nullptr, Operation* opCmp = nullptr,
+	                SelectAlgorithm algorithm = FLOYD_RIVEST);
+
+	/**
+	 * @brief Several order statistics at once
+	 *
+	 * The middle one of the requested ranks is selected with Floyd-Rivest, which also partitions the array around
+	 * it, and the ranks on each side are searched for only in their side. Every level of the recursion is linear in
+	 * n and there are log2(count) of them, instead of count selections over most of the array. Afterwards
+	 * values[k] is the element that would be there if the array was sorted for every requested k, and the elements
+	 * between two requested ranks are not smaller than the first and not greater than the second.
+	 *
+	 * @param values array of input values
+	 * @param n number of values in the input array
+	 * @param ranks ascending ranks in [0, n)
+	 * @param count number of ranks
+	 * @param opAsg optional counter for assignment operations
+	 * @param opCmp optional counter for comparison operations
+	 */
+	void multiSelect(int* values, int n, const int* ranks, int count, Operation* opAsg = nullptr,
+	                 Operation* opCmp = nullptr);
+
+	/**
+	 * @brief Sorts the k smallest values into values[0, k), the rest are left after them in no particular order
+	 *
+	 * @param values array of input values
+	 * @param n number of values in the input array
+	 * @param k number of values to sort, clamped to [0, n]
+	 * @param opAsg optional counter for assignment operations
+	 * @param opCmp optional counter for comparison operations
+	 */
+	void partialSort(int* values, int n, int k, Operation* opAsg = nullptr, Operation* opCmp = nullptr);
+
+	/**
+	 * @brief Benchmarking of the selection algorithms against std::nth_element and quickSelect
+	 *
+	 * @param profiler profiler to use
+	 */
+	void benchmarkSelection(Profiler& profiler);
+
+	/**
+	 * @brief Benchmarking of multiSelect on percentiles and of partialSort, against repeated selections and
+	 *        std::partial_sort
+	 *
+	 * @param profiler profiler to use
+	 */
+	void benchmarkMultiSelect(Profiler& profiler);
+
+} // namespace lab03
+
+#endif // __SELECTION_H__
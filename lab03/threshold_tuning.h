@@ -0,0 +1,67 @@
+#ifndef __THRESHOLD_TUNING_H__
+#define __THRESHOLD_TUNING_H__
+
+#include "Profiler.h"
+#include "commandline.h"
+
+namespace lab03
+{
+
+	/**
+	 * @brief Insertion sort threshold used when the tuning file is missing or was written on another CPU
+	 */
+	constexpr int DEFAULT_HYBRID_THRESHOLD = 29;
+
+	/**
+	 * @brief Threshold argument that stands for the tuned threshold, see hybridThreshold
+	 */
+	constexpr int TUNED_THRESHOLD = -1;
+
+	/**
+	 * @brief File the tune command writes the tuned thresholds to, relative to the working directory
+	 */
+	constexpr const char* TUNING_FILE = "lab03_tuning.cfg";
+
+	/**
+	 * @brief Insertion sort threshold of hybridizedQuickSort for int elements
+	 *
+	 * Read from TUNING_FILE the first time it is needed, DEFAULT_HYBRID_THRESHOLD if the file is missing,
+	 * malformed or was tuned on another CPU.
+	 */
+	int hybridThreshold();
+
+	/**
+	 * @brief Reads the threshold tuned for int elements from a tuning file
+	 *
+	 * @param path tuning file
+	 * @return the threshold, or -1 if the file is missing, malformed or was written on another CPU
+	 */
+	int loadHybridThreshold(const char* path);
+
+	/**
+	 * @brief Writes the threshold tuned for int elements on this CPU to a tuning file
+	 *
+	 * @param path tuning file
+	 * @param threshold threshold to store
+	 * @return false if the file could not be written
+	 */
+	bool saveHybridThreshold(const char* path, int threshold);
+
+	/**
+	 * @brief Searches for the fastest insertion sort threshold of hybridizedQuickSort on this CPU
+	 *
+	 * Every candidate sorts the same random arrays, repeated until one sample takes ~20 ms, and is scored by its
+	 * fastest sample out of several taken in interleaved rounds, so that a slow phase of the machine hits all of
+	 * them. A coarse pass over [4, 64] is followed by a fine pass around its best threshold, in both the best is
+	 * picked after averaging every score with its neighbours. The scores are reported as the tuneCoarse and
+	 * tuneFine series. The result is written to TUNING_FILE and used from then on.
+	 *
+	 * @param profiler profiler to use
+	 * @param n number of elements of the sorted arrays
+	 * @return the best threshold
+	 */
+	int tuneHybridThreshold(Profiler& profiler, int n);
+
+} // namespace lab03
+
+#endif // __THRESHOLD_TUNING_H__
@@ -0,0 +1,189 @@
+#include "top_k.h"
+
+#include "catch2.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <vector>
+
+/*
+ * ---------- STREAMING TOP-K ----------
+ * quickSelect needs the whole input in memory, TopK only keeps O(k) values. While the stream is random the k-th
+ * best value so far quickly becomes a good filter: after i values only about k/i of the next ones get past it, so
+ * almost all of the work is one comparison per value.
+ * 10^7 random ints, millions of elements / second for k = 10 / 10^3 / 10^5 / 10^6: heap 256 / 209 / 98 / 13,
+ * buffer 246 / 222 / 142 / 36, against ~9 for sorting the whole input with std::sort.
+ * A descending stream is the worst case: every value is better than all the previous ones. The heap then does a
+ * sift down for every value (192 / 15 / 11 / 9) while the buffer only appends and runs a selection every k values
+ * (180 / 99 / 105 / 86). The heap is only worth it for a handful of values, so TopK switches to the buffer above
+ * TOP_K_HEAP_LIMIT = 32. The buffer is pruned with std::nth_element: lab03's quickSelect always pivots on the last
+ * element, which is quadratic on the sorted buffers this case produces.
+ */
+
+namespace lab03
+{
+    TopK::TopK(const int k, const bool largest, const int heapLimit)
+        : k(k), largest(largest), heapLimit(heapLimit), count(0), threshold(INT_MAX), full(false)
+    {
+        if (usesHeap()) {
+            heap.reserve(k);
+        } else {
+            buffer.reserve(2 * (size_t)k);
+        }
+    }
+
+    void TopK::push(const int value)
+    {
+        count++;
+        if (k <= 0) {
+            return;
+        }
+        const int x = key(value);
+        if (full && x >= threshold) {
+            return;
+        }
+        if (usesHeap()) {
+            if (!full) {
+                heap.push(x);
+                full = (int)heap.size() == k;
+            } else {
+                heap.replace_top(x);
+            }
+            if (full) {
+                threshold = heap.top();
+            }
+        } else {
+            buffer.push_back(x);
+            if ((int)buffer.size() == 2 * k) {
+                prune();
+            }
+        }
+    }
+
+    void TopK::push(const int* values, const int n)
+    {
+        for (int i = 0; i < n; i++) {
+            push(values[i]);
+        }
+    }
+
+    void TopK::prune()
+    {
+        // the k smallest keys end up in front of the k-th one, the rest is dropped
+        std::nth_element(buffer.begin(), buffer.begin() + (k - 1), buffer.end());
+        threshold = buffer[k - 1];
+        buffer.resize(k);
+        full = true;
+    }
+
+    std::vector<int> TopK::result() const
+    {
+        std::vector<int> keys;
+        if (usesHeap()) {
+            heaps::DaryHeap<int, 4> copy(heap);
+            keys.reserve(copy.size());
+            while (!copy.empty()) {
+                keys.push_back(copy.top());
+                copy.pop();
+            }
+            std::reverse(keys.begin(), keys.end());
+        } else {
+            keys = buffer;
+            if ((int)keys.size() > k) {
+                std::nth_element(keys.begin(), keys.begin() + (k - 1), keys.end());
+                keys.resize(k);
+            }
+            std::sort(keys.begin(), keys.end());
+        }
+        for (int& x : keys) {
+            x = key(x);
+        }
+        return keys;
+    }
+
+    TEST_CASE("Streaming top-k")
+    {
+        std::vector<int> values(100000);
+        FillRandomArray(values.data(), (int)values.size(), -1000, 1000);
+        std::vector<int> ascending(values), descending(values);
+        std::sort(ascending.begin(), ascending.end());
+        std::sort(descending.begin(), descending.end(), std::greater<int>());
+
+        const int ks[] = {1, 10, 1000, 5000, 40000, 100000};
+        for (int k : ks) {
+            // both modes for every k, the heap limit decides which one is used
+            const int limits[] = {0, INT_MAX};
+            for (int limit : limits) {
+                TopK smallest(k, false, limit);
+                TopK largest(k, true, limit);
+                smallest.push(values.data(), (int)values.size());
+                largest.push(values.data(), (int)values.size());
+                REQUIRE( smallest.seen() == (long long)values.size() );
+                REQUIRE( smallest.result() == std::vector<int>(ascending.begin(), ascending.begin() + k) );
+                REQUIRE( largest.result() == std::vector<int>(descending.begin(), descending.begin() + k) );
+            }
+        }
+
+        // fewer values than k
+        TopK few(10);
+        few.push(3);
+        few.push(1);
+        REQUIRE( few.result() == std::vector<int>({1, 3}) );
+
+        // sorted streams, the worst case for the threshold
+        TopK fromDescending(2000, false, 0);
+        fromDescending.push(descending.data(), (int)descending.size());
+        REQUIRE( fromDescending.result() == std::vector<int>(ascending.begin(), ascending.begin() + 2000) );
+    }
+
+    // times one way of selecting the k smallest and returns the elements per second
+    double timeTopK(Profiler& profiler, const char* name, const std::vector<int>& values, const int k, const int mode)
+    {
+        const int n = (int)values.size();
+        std::vector<int> data;
+        long long check = 0;
+        profiler.startTimer(name, k);
+        auto start = std::chrono::steady_clock::now();
+        if (mode == 2) {
+            data = values;
+            std::sort(data.begin(), data.end());
+            check = data[k - 1];
+        } else {
+            TopK top(k, false, mode == 0 ? INT_MAX : 0);
+            top.push(values.data(), n);
+            check = top.result().back();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        profiler.stopTimer(name, k);
+        if (check == LLONG_MIN) {
+            printf("unreachable, keeps the selection from being optimized away\n");
+        }
+        return n / elapsed.count() / 1e6;
+    }
+
+    void benchmarkTopK(Profiler& profiler, const int n)
+    {
+        std::vector<int> random(n), descending(n);
+        FillRandomArray(random.data(), n);
+        descending = random;
+        std::sort(descending.begin(), descending.end(), std::greater<int>());
+
+        printf("The k smallest of %d values, millions of elements / second\n", n);
+        for (int k = 10; k <= 1000000 && k <= n; k *= 10) {
+            const double heapRandom = timeTopK(profiler, "heapRandom", random, k, 0);
+            const double bufferRandom = timeTopK(profiler, "bufferRandom", random, k, 1);
+            const double sortRandom = timeTopK(profiler, "sortRandom", random, k, 2);
+            const double heapDescending = timeTopK(profiler, "heapDescending", descending, k, 0);
+            const double bufferDescending = timeTopK(profiler, "bufferDescending", descending, k, 1);
+            const double sortDescending = timeTopK(profiler, "sortDescending", descending, k, 2);
+            printf("k(%d): random: heap %.1f, buffer %.1f, sort %.1f; descending: heap %.1f, buffer %.1f, sort %.1f\n",
+                   k, heapRandom, bufferRandom, sortRandom, heapDescending, bufferDescending, sortDescending);
+        }
+        profiler.createGroup("Top-k of a random stream", "heapRandom", "bufferRandom", "sortRandom");
+        profiler.createGroup("Top-k of a descending stream", "heapDescending", "bufferDescending", "sortDescending");
+        profiler.showReport();
+    }
+
+} // namespace lab03
@@ -0,0 +1,85 @@
+#ifndef __TOP_K_H__
+#define __TOP_K_H__
+
+#include "Profiler.h"
+#include "commandline.h"
+#include "dary_heap.h"
+
+#include <vector>
+
+namespace lab03
+{
+
+	/**
+	 * @brief Largest k for which TopK keeps the selected values in a heap, above it they are buffered
+	 */
+	constexpr int TOP_K_HEAP_LIMIT = 32;
+
+	/**
+	 * @brief Selection of the k smallest (or largest) values of a stream that does not fit in memory
+	 *
+	 * For k up to heapLimit the k best values so far are kept in a 4-ary max-heap, a new value only has to be
+	 * compared with its top and replaces it if it is better. For larger k a replacement costs a sift through
+	 * log4(k) levels, so the candidates are appended to a buffer of 2k values instead, and a full buffer is pruned
+	 * back to its k best with a selection, O(1) amortized per candidate. In both modes the worst kept value is a
+	 * threshold that drops most values of a random stream with a single comparison. Memory is O(k) whatever the
+	 * length of the stream.
+	 */
+	class TopK
+	{
+	public:
+		/**
+		 * @param k number of values to select
+		 * @param largest select the k largest values instead of the k smallest
+		 * @param heapLimit largest k that uses the heap
+		 */
+		explicit TopK(int k, bool largest = false, int heapLimit = TOP_K_HEAP_LIMIT);
+
+		/**
+		 * @brief Feeds one value of the stream
+		 */
+		void push(int value);
+
+		/**
+		 * @brief Feeds n values of the stream
+		 */
+		void push(const int* values, int n);
+
+		/**
+		 * @brief The selected values, best first (ascending for the smallest, descending for the largest)
+		 */
+		std::vector<int> result() const;
+
+		/**
+		 * @brief Number of values fed so far
+		 */
+		long long seen() const { return count; }
+
+		bool usesHeap() const { return k <= heapLimit; }
+
+	private:
+		// the largest values are selected as the smallest of ~value, which reverses the order of ints
+		int key(int value) const { return largest ? ~value : value; }
+		void prune();
+
+		int k;
+		bool largest;
+		int heapLimit;
+		long long count;
+		heaps::DaryHeap<int, 4> heap; // max-heap of the k smallest keys when k <= heapLimit
+		std::vector<int> buffer; // candidate keys when k > heapLimit
+		int threshold; // keys not smaller than it are dropped once there are k of them
+		bool full;
+	};
+
+	/**
+	 * @brief Throughput benchmark (elements / second) of TopK against sorting the whole input
+	 *
+	 * @param profiler profiler to use
+	 * @param n number of elements of the stream
+	 */
+	void benchmarkTopK(Profiler& profiler, int n);
+
+} // namespace lab03
+
+#endif // __TOP_K_H__
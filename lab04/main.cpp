@@ -33,13 +33,21 @@ void perf(const CommandArgs& args)
     profiler.reset();
 }
 
+void benchMeld(const CommandArgs& args)
+{
+    const int n = args.empty() ? 1000000 : atoi(args[0]);
+    benchmarkMeld(profiler, n);
+    profiler.reset();
+}
+
 int main()
 {
     const std::vector<CommandSpec> commands =
     {
         {"demo", demo, "run demo"},
         {"test", test, "run unit-tests"},
-        {"perf", perf, "[fixed_k(default)|fixed_n] - run performance analysis on selected case"}
+        {"perf", perf, "[fixed_k(default)|fixed_n] - run performance analysis on selected case"},
+        {"bench_meld", benchMeld, "[n(default 10^6)] - run benchmarks of the pairing heap against the binary heap"}
     };
     return runCommandLoop(commands);
 }
\ No newline at end of file
@@ -132,6 +132,16 @@ namespace lab04
 	 */
 	ListT* merge_k_lists(ListT* lists[], int size, Operation* op = nullptr);
 
+	/**
+	 * @brief The algorithm of merging the k sorted lists, with a pairing heap of lists instead of the binary heap.
+	 *
+	 * @param lists the array of list
+	 * @param size number of lists in the array
+	 * @param op optional counter for operations 
+	 * @return the resulting ascendingly sorted list.
+	 */
+	ListT* merge_k_lists_pairing(ListT* lists[], int size, Operation* op = nullptr);
+
 
 	/**
 	 * @brief Demo code for the list functions, list generation and merging algorithms. 
@@ -149,6 +159,15 @@ namespace lab04
 	 */
 	void performance(Profiler& profiler, ListsCase whichCase);
 
+	/**
+	 * @brief Benchmark of the pairing heap against the binary heap: k-way merges of lists and
+	 *        k queues combined two by two into one, from which the smallest elements are taken.
+	 *
+	 * @param profiler profiler to use
+	 * @param n the total number of elements
+	 */
+	void benchmarkMeld(Profiler& profiler, int n);
+
 } // namespace lab04
 
 #endif // __MERGE_LISTS_H__
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include <commandline.h>
 #include "sets.h"
 
+#define CATCH_CONFIG_RUNNER
+#include "catch2.hpp"
+
 Profiler profiler("disjoint_sets");
 
 void demo(const CommandArgs& args) {
@@ -10,6 +13,12 @@ void demo(const CommandArgs& args) {
     lab08::demonstrate();
 }
 
+void test(const CommandArgs& args)
+{
+    static Catch::Session session;
+    session.run();
+}
+
 void perf(const CommandArgs& args)
 {
     lab08::performance(profiler);
@@ -21,6 +30,7 @@ int main() {
     const std::vector<CommandSpec> commands =
     {
         {"demo", demo, "Run demo, optional argument for size"},
+        {"test", test, "Run unit-tests"},
         {"perf", perf, "Generate charts"}
     };
     return runCommandLoop(commands);
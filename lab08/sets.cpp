@@ -1,4 +1,5 @@
 #include "sets.h"
+#include "catch2.hpp"
 
 /*
  * 1. Complexity Analysis:
@@ -12,6 +13,12 @@
  * performs 2 finds for every edge considered.
  * due to path compression, the cost of FIND operations remains very low
  * even as N increases.
+ *
+ * 2. Prim and Dijkstra:
+ * Both grow a tree from one vertex and keep every vertex next to it in an indexed heap keyed by the
+ * cheapest edge (Prim) or the shortest distance (Dijkstra) found so far, lowered with decrease-key.
+ * That is O(E log V) with at most V entries in the heap, instead of sorting all E edges up front.
+ * On the generated graphs (E = 4N) the heap operations grow as N log N, like the sort of Kruskal.
  */
 
 namespace lab08
@@ -22,40 +29,6 @@ namespace lab08
         return distrib(gen);
     }
 
-    int partition(Edge* values, const int l, const int r) {
-        const int rand_idx = random_number(l, r);
-        std::swap(values[r], values[rand_idx]);
-
-        const int pivot = values[r].weight; // always pick the last element as pivot
-        int i = l;
-        for (int j = l; j < r; j++) {
-            if (values[j].weight <= pivot) {
-                if (i != j) {
-                    std::swap(values[i], values[j]);
-                }
-                i++;
-            }
-        }
-        std::swap(values[r], values[i]);
-        return i;
-    }
-
-    void qsort(Edge* values, const int l, const int r) {
-        if (l >= r) {
-            return;
-        }
-
-        const int pivot = partition(values, l, r);
-
-        qsort(values, l, pivot - 1);
-        qsort(values, pivot + 1, r);
-    }
-
-    void quickSort(Edge* values, const int n)
-    {
-        qsort(values, 0, n - 1);
-    }
-
     Set* make_set(const int x, Operation* op) {
         Set* elem = new Set;
         elem->key = x;
@@ -153,7 +126,8 @@ namespace lab08
         *out_size = 0;
         *mst = new Edge[nr_vertices - 1]; // allocate data for the list of edges, maximum N - 1
 
-        quickSort(edges, size); // sort the list of edges
+        // sort the list of edges by weight
+        sorting::quick_sort(edges, edges + size, sorting::less(), [](const Edge& e) { return e.weight; });
 
         for (int i = 0; i < size; i++) { // loop through edges
             if (*out_size == nr_vertices - 1) {
@@ -180,6 +154,90 @@ namespace lab08
         delete[] vertices;
     }
 
+    // adjacency lists of the undirected graph in one array, the neighbours of v are
+    // adj[start[v]] ... adj[start[v + 1] - 1], each stored as the index of the edge
+    void build_adjacency(int nr_vertices, const Edge* edges, int size, std::vector<int>& start, std::vector<int>& adj) {
+        start.assign(nr_vertices + 1, 0);
+        for (int i = 0; i < size; i++) {
+            start[edges[i].from + 1]++;
+            start[edges[i].to + 1]++;
+        }
+        for (int v = 0; v < nr_vertices; v++) {
+            start[v + 1] += start[v];
+        }
+        adj.resize(2 * size);
+        std::vector<int> next(start.begin(), start.end() - 1);
+        for (int i = 0; i < size; i++) {
+            adj[next[edges[i].from]++] = i;
+            adj[next[edges[i].to]++] = i;
+        }
+    }
+
+    void prim(int nr_vertices, const Edge* edges, const int size, Edge** mst, int *out_size, Operation* heap_op) {
+        *out_size = 0;
+        *mst = new Edge[nr_vertices > 1 ? nr_vertices - 1 : 1];
+        if (nr_vertices == 0) {
+            return;
+        }
+
+        std::vector<int> start, adj;
+        build_adjacency(nr_vertices, edges, size, start, adj);
+
+        // the queue holds the vertices next to the tree, keyed by the weight of the cheapest edge reaching them
+        heaps::IndexedHeap<int> queue(nr_vertices);
+        queue.setCounters(heap_op, heap_op);
+        std::vector<int> via(nr_vertices, -1); // that cheapest edge
+        std::vector<bool> in_tree(nr_vertices, false);
+
+        for (int root = 0; root < nr_vertices; root++) { // one tree for every component
+            if (in_tree[root]) {
+                continue;
+            }
+            queue.push(root, 0);
+            while (!queue.empty()) {
+                const int u = queue.pop_min();
+                in_tree[u] = true;
+                if (via[u] >= 0) {
+                    (*mst)[(*out_size)++] = edges[via[u]];
+                }
+                for (int k = start[u]; k < start[u + 1]; k++) {
+                    const Edge& e = edges[adj[k]];
+                    const int v = e.from == u ? e.to : e.from;
+                    if (!in_tree[v] && queue.push_or_decrease(v, e.weight)) {
+                        via[v] = adj[k];
+                    }
+                }
+            }
+        }
+    }
+
+    void dijkstra(int nr_vertices, const Edge* edges, const int size, int source, int* dist, int* parent, Operation* heap_op) {
+        std::vector<int> start, adj;
+        build_adjacency(nr_vertices, edges, size, start, adj);
+
+        for (int v = 0; v < nr_vertices; v++) {
+            dist[v] = INT_MAX;
+            parent[v] = -1;
+        }
+
+        heaps::IndexedHeap<int> queue(nr_vertices);
+        queue.setCounters(heap_op, heap_op);
+        dist[source] = 0;
+        queue.push(source, 0);
+        while (!queue.empty()) {
+            const int u = queue.pop_min();
+            for (int k = start[u]; k < start[u + 1]; k++) {
+                const Edge& e = edges[adj[k]];
+                const int v = e.from == u ? e.to : e.from;
+                if (dist[u] + e.weight < dist[v]) {
+                    dist[v] = dist[u] + e.weight;
+                    parent[v] = u;
+                    queue.push_or_decrease(v, dist[v]);
+                }
+            }
+        }
+    }
+
     // this function generates a list of edges for vertices 0 - N-1
     void generate_edges(int N, Edge** edges, int *out_size) {
         if (out_size == nullptr || edges == nullptr) {
@@ -279,6 +337,23 @@ namespace lab08
 
         delete[] mst;
 
+        prim(5, edges, 9, &mst, &size);
+        int total = 0;
+        printf("\nMST found by Prim:\n");
+        for (int i = 0; i < size; i++) {
+            printf("%d-%d\n", mst[i].from, mst[i].to);
+            total += mst[i].weight;
+        }
+        printf("total weight: %d\n", total);
+        delete[] mst;
+
+        int dist[5], parent[5];
+        dijkstra(5, edges, 9, 0, dist, parent);
+        printf("\nShortest distances from 0 (Dijkstra):\n");
+        for (int v = 0; v < 5; v++) {
+            printf("%d: %d (through %d)\n", v, dist[v], parent[v]);
+        }
+
         Edge* edge_list = nullptr;
         int nr_edges = 0;
         generate_edges(10, &edge_list, &nr_edges);
@@ -315,6 +390,10 @@ namespace lab08
                 //printf("mst done\n");
                 //fflush(stdout);
                 delete[] mst;
+
+                Operation prim_op = profiler.createOperation("prim_heap", n);
+                prim(n, edges, nr_edges, &mst, &nr_mst_edges, &prim_op);
+                delete[] mst;
                 delete[] edges;
             }
         }
@@ -323,6 +402,153 @@ namespace lab08
         profiler.divideValues("union", 5);
         profiler.divideValues("find", 5);
         profiler.createGroup("Set operations", "make", "union", "find");
+        profiler.divideValues("prim_heap", 5);
+    }
+
+    long long total_weight(const Edge* edges, const int size) {
+        long long total = 0;
+        for (int i = 0; i < size; i++) {
+            total += edges[i].weight;
+        }
+        return total;
+    }
+
+    // two generated graphs side by side, the second one on the vertices n1 ... n1 + n2 - 1
+    void generate_two_components(int n1, int n2, std::vector<Edge>& edges) {
+        edges.clear();
+        const int sizes[] = {n1, n2};
+        int offset = 0;
+        for (int n : sizes) {
+            Edge* generated = nullptr;
+            int count = 0;
+            generate_edges(n, &generated, &count);
+            for (int i = 0; i < count; i++) {
+                edges.push_back({generated[i].from + offset, generated[i].to + offset, generated[i].weight});
+            }
+            delete[] generated;
+            offset += n;
+        }
+    }
+
+    TEST_CASE("Prim matches the weight of Kruskal's MST") {
+        const int sizes[] = {2, 3, 10, 100, 1000, 3000};
+        for (int n : sizes) {
+            Edge* edges = nullptr;
+            int size = 0;
+            generate_edges(n, &edges, &size);
+            std::vector<Edge> sorted(edges, edges + size); // kruskal sorts its input
+
+            Edge* kruskal_mst = nullptr;
+            Edge* prim_mst = nullptr;
+            int kruskal_size = 0, prim_size = 0;
+            kruskal(n, sorted.data(), size, &kruskal_mst, &kruskal_size);
+            prim(n, edges, size, &prim_mst, &prim_size);
+
+            REQUIRE( kruskal_size == n - 1 );
+            REQUIRE( prim_size == n - 1 );
+            REQUIRE( total_weight(prim_mst, prim_size) == total_weight(kruskal_mst, kruskal_size) );
+
+            // the edges of prim span the graph without a cycle
+            std::vector<Set*> vertices;
+            for (int v = 0; v < n; v++) {
+                vertices.push_back(make_set(v));
+            }
+            for (int i = 0; i < prim_size; i++) {
+                Set* from = vertices[prim_mst[i].from];
+                Set* to = vertices[prim_mst[i].to];
+                REQUIRE( find_set(from) != find_set(to) );
+                set_union(from, to);
+            }
+            for (Set* set : vertices) {
+                delete set;
+            }
+
+            delete[] kruskal_mst;
+            delete[] prim_mst;
+            delete[] edges;
+        }
+
+        // a forest, one tree for every component
+        std::vector<Edge> edges, sorted;
+        generate_two_components(50, 70, edges);
+        sorted = edges;
+        Edge* kruskal_mst = nullptr;
+        Edge* prim_mst = nullptr;
+        int kruskal_size = 0, prim_size = 0;
+        kruskal(120, sorted.data(), (int)sorted.size(), &kruskal_mst, &kruskal_size);
+        prim(120, edges.data(), (int)edges.size(), &prim_mst, &prim_size);
+        REQUIRE( prim_size == 118 );
+        REQUIRE( kruskal_size == 118 );
+        REQUIRE( total_weight(prim_mst, prim_size) == total_weight(kruskal_mst, kruskal_size) );
+        delete[] kruskal_mst;
+        delete[] prim_mst;
+    }
+
+    // Bellman-Ford on the undirected graph, the reference for dijkstra
+    std::vector<long long> shortest_paths(int nr_vertices, const std::vector<Edge>& edges, int source) {
+        std::vector<long long> dist(nr_vertices, LLONG_MAX);
+        dist[source] = 0;
+        for (bool changed = true; changed; ) {
+            changed = false;
+            for (const Edge& e : edges) {
+                if (dist[e.from] != LLONG_MAX && dist[e.from] + e.weight < dist[e.to]) {
+                    dist[e.to] = dist[e.from] + e.weight;
+                    changed = true;
+                }
+                if (dist[e.to] != LLONG_MAX && dist[e.to] + e.weight < dist[e.from]) {
+                    dist[e.from] = dist[e.to] + e.weight;
+                    changed = true;
+                }
+            }
+        }
+        return dist;
+    }
+
+    void check_dijkstra(int n, const std::vector<Edge>& edges, int source) {
+        std::vector<int> dist(n), parent(n);
+        dijkstra(n, edges.data(), (int)edges.size(), source, dist.data(), parent.data());
+        const std::vector<long long> expected = shortest_paths(n, edges, source);
+
+        std::map<std::pair<int, int>, int> weight;
+        for (const Edge& e : edges) {
+            weight[std::make_pair(e.from, e.to)] = e.weight;
+            weight[std::make_pair(e.to, e.from)] = e.weight;
+        }
+        for (int v = 0; v < n; v++) {
+            if (expected[v] == LLONG_MAX) {
+                REQUIRE( dist[v] == INT_MAX );
+                REQUIRE( parent[v] == -1 );
+                continue;
+            }
+            REQUIRE( dist[v] == expected[v] );
+            if (v == source) {
+                REQUIRE( parent[v] == -1 );
+            } else {
+                // the parent is the last step of a shortest path
+                REQUIRE( weight.count(std::make_pair(parent[v], v)) == 1 );
+                REQUIRE( dist[parent[v]] + weight[std::make_pair(parent[v], v)] == dist[v] );
+            }
+        }
+    }
+
+    TEST_CASE("Dijkstra matches Bellman-Ford") {
+        const int sizes[] = {2, 3, 10, 100, 1000, 3000};
+        for (int n : sizes) {
+            Edge* generated = nullptr;
+            int size = 0;
+            generate_edges(n, &generated, &size);
+            const std::vector<Edge> edges(generated, generated + size);
+            delete[] generated;
+
+            check_dijkstra(n, edges, 0);
+            check_dijkstra(n, edges, random_number(0, n - 1));
+        }
+
+        // the vertices of the other component stay unreachable
+        std::vector<Edge> edges;
+        generate_two_components(50, 70, edges);
+        check_dijkstra(120, edges, 10);
+        check_dijkstra(120, edges, 100);
     }
 }
 